@@ -0,0 +1,72 @@
+#include "command_executor.hpp"
+#include <extdll.h>
+#include <chrono>
+
+extern enginefuncs_t g_engfuncs;
+
+CommandExecutor::CommandExecutor()
+    : m_batchDone(0)
+    , m_batchTotal(0)
+    , m_avgCostUs(50.0)
+{
+}
+
+void CommandExecutor::enqueue(const std::string& text) {
+    if (m_pending.empty()) {
+        // Previous batch finished; start counting a new one
+        m_batchDone = 0;
+        m_batchTotal = 0;
+    }
+
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+
+        size_t len = end - start;
+        if (len > 0 && text[start + len - 1] == '\r') len--;
+
+        if (len > 0 && text.compare(start, 2, "//") != 0) {
+            std::string line = text.substr(start, len);
+            line += '\n';
+            m_pending.push_back(std::move(line));
+            m_batchTotal.fetch_add(1, std::memory_order_relaxed);
+        }
+        start = end + 1;
+    }
+}
+
+void CommandExecutor::runFrame(FrameBudget& budget) {
+    if (m_pending.empty()) return;
+
+    // Always make progress, then add lines while the estimated execute
+    // cost still fits in what is left of the frame
+    int64_t remainingUs = budget.remainingUs();
+    size_t bytes = 0;
+    unsigned issued = 0;
+
+    while (!m_pending.empty()) {
+        const std::string& line = m_pending.front();
+        if (issued > 0) {
+            if (bytes + line.size() > MAX_BYTES_PER_FRAME ||
+                (issued + 1) * m_avgCostUs > remainingUs) {
+                budget.markExhausted();
+                break;
+            }
+        }
+
+        g_engfuncs.pfnServerCommand(line.c_str());
+        bytes += line.size();
+        issued++;
+        m_pending.pop_front();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    g_engfuncs.pfnServerExecute();
+    double elapsedUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    m_avgCostUs = m_avgCostUs * 0.75 + (elapsedUs / issued) * 0.25;
+    m_batchDone.fetch_add(issued, std::memory_order_relaxed);
+    budget.defer(m_pending.size());
+}
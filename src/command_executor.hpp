@@ -0,0 +1,44 @@
+#ifndef COMMAND_EXECUTOR_HPP
+#define COMMAND_EXECUTOR_HPP
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+#include "frame_budget.hpp"
+
+// Game-thread queue of console command lines. Each frame it appends as
+// many lines as fit the frame budget to the engine's command buffer and
+// runs them with a single pfnServerExecute. Large pastes are spread over
+// several frames; progress is readable from the GUI thread.
+class CommandExecutor {
+public:
+    CommandExecutor();
+
+    // Queue one or more newline-separated command lines
+    void enqueue(const std::string& text);
+    void enqueue(const char* text) { enqueue(std::string(text)); }
+
+    // Issue the next slice of commands; called once per frame
+    void runFrame(FrameBudget& budget);
+
+    bool busy() const { return !m_pending.empty(); }
+    size_t pending() const { return m_pending.size(); }
+
+    // Progress of the current batch (safe from any thread)
+    unsigned batchDone() const { return m_batchDone.load(std::memory_order_relaxed); }
+    unsigned batchTotal() const { return m_batchTotal.load(std::memory_order_relaxed); }
+
+private:
+    std::deque<std::string> m_pending;
+    std::atomic<unsigned> m_batchDone;
+    std::atomic<unsigned> m_batchTotal;
+
+    // Running estimate of what one command costs inside pfnServerExecute
+    double m_avgCostUs;
+
+    // Stay well under the engine's 8 KiB command buffer per frame
+    static constexpr size_t MAX_BYTES_PER_FRAME = 4096;
+};
+
+#endif // COMMAND_EXECUTOR_HPP
@@ -6,6 +6,10 @@
 void dll_pfnServerActivate(edict_t *pEdictList, int edictCount, int clientMax);
 void dll_pfnStartFrame();
 void postDll_pfnStartFrame();
+qboolean postDll_pfnClientConnect(edict_t *pEntity, const char *pszName, const char *pszAddress, char szRejectReason[128]);
+void postDll_pfnClientDisconnect(edict_t *pEntity);
+void postDll_pfnClientPutInServer(edict_t *pEntity);
+void postDll_pfnClientUserInfoChanged(edict_t *pEntity, char *infobuffer);
 
 // DLL_FUNCTIONS table with minimal hooks
 DLL_FUNCTIONS g_DllFunctionTable =
@@ -35,7 +39,7 @@ DLL_FUNCTIONS g_DllFunctionTable =
 	NULL,					// pfnServerDeactivate
 	NULL,					// pfnPlayerPreThink
 	NULL,					// pfnPlayerPostThink
-	dll_pfnStartFrame,		// pfnStartFrame - we hook this to process FLTK events
+	dll_pfnStartFrame,		// pfnStartFrame - we hook this to drain GUI queues
 	NULL,					// pfnParmsNewLevel
 	NULL,					// pfnParmsChangeLevel
 	NULL,					// pfnGetGameDescription
@@ -62,7 +66,7 @@ DLL_FUNCTIONS g_DllFunctionTable =
 	NULL,					// pfnAllowLagCompensation
 };
 
-// Post DLL_FUNCTIONS table (all NULL for minimal plugin)
+// Post DLL_FUNCTIONS table
 DLL_FUNCTIONS g_DllFunctionTable_Post =
 {
 	NULL,					// pfnGameInit
@@ -80,12 +84,12 @@ DLL_FUNCTIONS g_DllFunctionTable_Post =
 	NULL,					// pfnSaveGlobalState
 	NULL,					// pfnRestoreGlobalState
 	NULL,					// pfnResetGlobalState
-	NULL,					// pfnClientConnect
-	NULL,					// pfnClientDisconnect
+	postDll_pfnClientConnect,	// pfnClientConnect - player registry
+	postDll_pfnClientDisconnect,	// pfnClientDisconnect
 	NULL,					// pfnClientKill
-	NULL,					// pfnClientPutInServer
+	postDll_pfnClientPutInServer,	// pfnClientPutInServer
 	NULL,					// pfnClientCommand
-	NULL,					// pfnClientUserInfoChanged
+	postDll_pfnClientUserInfoChanged,	// pfnClientUserInfoChanged
 	NULL,					// pfnServerActivate
 	NULL,					// pfnServerDeactivate
 	NULL,					// pfnPlayerPreThink
@@ -138,10 +142,10 @@ NEW_DLL_FUNCTIONS g_NewDllFunctionTable_Post =
 // Select current map in dropdown when server activates (map loaded)
 void dll_pfnServerActivate(edict_t *pEdictList, int edictCount, int clientMax) {
 	SET_META_RESULT(MRES_IGNORED);
-	FltkGUI::getInstance().selectCurrentMap();
+	FltkGUI::getInstance().onServerActivate();
 }
 
-// Process FLTK events each frame
+// Drain GUI work queues each frame (FLTK itself runs on its own thread)
 void dll_pfnStartFrame() {
 	SET_META_RESULT(MRES_IGNORED);
 	FltkGUI::getInstance().processEvents();
@@ -151,6 +155,31 @@ void postDll_pfnStartFrame() {
 	SET_META_RESULT(MRES_IGNORED);
 }
 
+// Client hooks run after the game DLL, so a rejected connect is never
+// recorded and names are the ones the game settled on
+qboolean postDll_pfnClientConnect(edict_t *pEntity, const char *pszName, const char *pszAddress, char szRejectReason[128]) {
+	SET_META_RESULT(MRES_IGNORED);
+	if (META_RESULT_ORIG_RET(qboolean)) {
+		FltkGUI::getInstance().onClientConnect(pEntity, pszName);
+	}
+	return TRUE;
+}
+
+void postDll_pfnClientDisconnect(edict_t *pEntity) {
+	SET_META_RESULT(MRES_IGNORED);
+	FltkGUI::getInstance().onClientDisconnect(pEntity);
+}
+
+void postDll_pfnClientPutInServer(edict_t *pEntity) {
+	SET_META_RESULT(MRES_IGNORED);
+	FltkGUI::getInstance().onClientPutInServer(pEntity);
+}
+
+void postDll_pfnClientUserInfoChanged(edict_t *pEntity, char *infobuffer) {
+	SET_META_RESULT(MRES_IGNORED);
+	FltkGUI::getInstance().onClientUserInfoChanged(pEntity, infobuffer);
+}
+
 C_DLLEXPORT int GetEntityAPI2(DLL_FUNCTIONS *pFunctionTable, int *interfaceVersion)
 {
 	if (!pFunctionTable) {
@@ -1,6 +1,7 @@
 #include <extdll.h>
 #include <meta_api.h>
 #include "fltk_gui.hpp"
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <string>
@@ -17,41 +18,73 @@ void ServerPrint_Post(const char* msg)
 {
 	// Log ServerPrint calls from game DLL or plugins
 	if (msg && msg[0] && msg[0] != '\n') {
-		// Strip trailing newline for cleaner log display
-		std::string clean(msg);
-		while (!clean.empty() && (clean.back() == '\n' || clean.back() == '\r')) {
-			clean.pop_back();
+		// Strip trailing newline for cleaner log display; no copy, so a
+		// flood the limiter drops costs next to nothing
+		size_t len = strlen(msg);
+		while (len > 0 && (msg[len-1] == '\n' || msg[len-1] == '\r')) {
+			len--;
 		}
-		if (!clean.empty()) {
-			FltkGUI::getInstance().appendLog(clean.c_str());
+		if (len > 0) {
+			FltkGUI::getInstance().appendLog(std::string_view(msg, len), LogOrigin::ServerPrint);
 		}
 	}
 	RETURN_META(MRES_IGNORED);
 }
 
+// Trims the line ending and hands the text over without copying it
+static void logGameEvent(const char* text, size_t len)
+{
+	while (len > 0 && (text[len-1] == '\n' || text[len-1] == '\r')) {
+		len--;
+	}
+	if (len > 0) {
+		FltkGUI::getInstance().appendGameEvent(std::string_view(text, len));
+	}
+}
+
+// Messages too long for the usual buffer are formatted again here, still on
+// the stack, up to the longest line the log keeps
+static void __attribute__((noinline)) logLongGameEvent(const char* szFmt, va_list args)
+{
+	char buffer[LogStore::MAX_LINE_BYTES + 1];
+	int len = vsnprintf(buffer, sizeof(buffer), szFmt, args);
+	if (len > 0) {
+		logGameEvent(buffer, std::min((size_t)len, sizeof(buffer) - 1));
+	}
+}
+
 void AlertMessage_Post(ALERT_TYPE atype, const char* szFmt, ...)
 {
 	// Only capture at_logged messages (multiplayer game events)
-	if (atype != at_logged)
+	if (atype != at_logged || !szFmt)
 	{
 		RETURN_META(MRES_IGNORED);
 	}
 
-	char buffer[1024];
 	va_list args;
 	va_start(args, szFmt);
-	vsnprintf(buffer, sizeof(buffer), szFmt, args);
-	va_end(args);
-
-	// Strip trailing newline
-	size_t len = strlen(buffer);
-	while (len > 0 && (buffer[len-1] == '\n' || buffer[len-1] == '\r')) {
-		buffer[--len] = '\0';
-	}
-
-	if (len > 0) {
-		FltkGUI::getInstance().appendLog(buffer);
+	if (strcmp(szFmt, "%s") == 0) {
+		// UTIL_LogPrintf formats the line itself and passes it through "%s",
+		// so the usual event needs no formatting at all
+		const char* text = va_arg(args, const char*);
+		if (text) {
+			logGameEvent(text, strlen(text));
+		}
+	} else if (!strchr(szFmt, '%')) {
+		logGameEvent(szFmt, strlen(szFmt));
+	} else {
+		char buffer[1024];
+		va_list retry;
+		va_copy(retry, args);
+		int len = vsnprintf(buffer, sizeof(buffer), szFmt, args);
+		if (len >= (int)sizeof(buffer)) {
+			logLongGameEvent(szFmt, retry);
+		} else if (len > 0) {
+			logGameEvent(buffer, (size_t)len);
+		}
+		va_end(retry);
 	}
+	va_end(args);
 	RETURN_META(MRES_IGNORED);
 }
 
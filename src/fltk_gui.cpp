@@ -1,4 +1,5 @@
 #include "fltk_gui.hpp"
+#include "line_splitter.hpp"
 #include "icon.xpm"
 #include <extdll.h>
 #include <meta_api.h>
@@ -7,14 +8,18 @@
 #include <FL/Fl_Scrollbar.H>
 #include <cstring>
 #include <cstdio>
+#include <cstdlib>
 #include <algorithm>
-#include <fcntl.h>
-#include <poll.h>
-#include <dirent.h>
+#include <chrono>
 
 extern enginefuncs_t g_engfuncs;
 extern globalvars_t* gpGlobals;
 
+static int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // HoverButton implementation
 HoverButton::HoverButton(int x, int y, int w, int h, const char* label)
     : Fl_Button(x, y, w, h, label)
@@ -94,28 +99,45 @@ void HoverToggleButton::draw() {
 // ScrollChoice implementation - a choice widget with scrollable popup
 ScrollChoice::ScrollChoice(int x, int y, int w, int h, const char* label)
     : Fl_Widget(x, y, w, h, label)
+    , m_items(std::make_shared<const std::vector<std::string>>())
 {
 }
 
+ScrollChoice::~ScrollChoice() {
+    if (m_popup) {
+        m_popup->detach();
+        m_popup->finish(0);
+    }
+}
+
 void ScrollChoice::add(const char* text) {
-    m_items.push_back(text ? text : "");
+    // Copy on write; the current list may be shared
+    auto list = std::make_shared<std::vector<std::string>>(*m_items);
+    list->push_back(text ? text : "");
+    m_items = std::move(list);
 }
 
 void ScrollChoice::clear() {
-    m_items.clear();
+    m_items = std::make_shared<const std::vector<std::string>>();
     m_value = 0;
 }
 
+void ScrollChoice::items(ItemList list) {
+    m_items = list ? std::move(list) : std::make_shared<const std::vector<std::string>>();
+    if (m_value >= (int)m_items->size()) m_value = 0;
+    redraw();
+}
+
 void ScrollChoice::value(int v) {
-    if (v >= 0 && v < (int)m_items.size()) {
+    if (v >= 0 && v < (int)m_items->size()) {
         m_value = v;
         redraw();
     }
 }
 
 const char* ScrollChoice::text() const {
-    if (m_value >= 0 && m_value < (int)m_items.size()) {
-        return m_items[m_value].c_str();
+    if (m_value >= 0 && m_value < (int)m_items->size()) {
+        return (*m_items)[m_value].c_str();
     }
     return "";
 }
@@ -152,8 +174,8 @@ void ScrollChoice::draw() {
     fl_font(FL_HELVETICA, m_textsize);
     int tx = x() + 6;
     int tw = w() - 20;
-    if (!m_items.empty() && m_value >= 0 && m_value < (int)m_items.size()) {
-        fl_draw(m_items[m_value].c_str(), tx, y(), tw, h(), FL_ALIGN_LEFT);
+    if (!m_items->empty() && m_value >= 0 && m_value < (int)m_items->size()) {
+        fl_draw((*m_items)[m_value].c_str(), tx, y(), tw, h(), FL_ALIGN_LEFT);
     }
 
     // Draw dropdown arrow
@@ -163,173 +185,136 @@ void ScrollChoice::draw() {
     fl_polygon(ax, ay - 3, ax + 6, ay - 3, ax + 3, ay + 3);
 }
 
-// Static callback for popup browser selection
-void ScrollChoice::popupCallback(Fl_Widget* w, void* data) {
-    Fl_Hold_Browser* browser = static_cast<Fl_Hold_Browser*>(w);
-    Fl_Window* popup = browser->window();
-    // Store selection in popup's user_data
-    popup->user_data(reinterpret_cast<void*>(static_cast<intptr_t>(browser->value())));
-    popup->hide();
-}
-
-void ScrollChoice::showPopup() {
-    if (m_items.empty()) return;
-
-    // Calculate popup height
-    int itemH = m_textsize + 6;
-    int popupH = (int)m_items.size() * itemH + 4;
-    if (popupH > m_maxHeight) popupH = m_maxHeight;
-
-    // Convert widget coordinates to screen coordinates
-    int screenX = 0, screenY = 0;
-    Fl_Window* win = window();
-    if (win) {
-        screenX = win->x() + x();
-        screenY = win->y() + y();
-    }
-
-    // Create popup window over the widget (replacing it visually)
-    int popupY = screenY;
-    int screenH = Fl::h();
-    if (popupY + popupH > screenH) {
-        popupY = screenH - popupH;
-        if (popupY < 0) popupY = 0;
-    }
-
-    Fl_Menu_Window* popup = new Fl_Menu_Window(screenX, popupY, w(), popupH);
-    popup->set_modal();
-    popup->set_override();  // Bypass window manager - no animations
-    popup->clear_border();
-    popup->user_data(nullptr);  // Will store selection
+// ScrollChoicePopup implementation
+ScrollChoicePopup::ScrollChoicePopup(ScrollChoice* owner, int x, int y, int w, int h)
+    : Fl_Menu_Window(x, y, w, h)
+    , m_owner(owner)
+    , m_items(owner->m_items)
+{
+    set_modal();
+    set_override();  // Bypass window manager - no animations
+    clear_border();
 
-    Fl_Hold_Browser* browser = new Fl_Hold_Browser(0, 0, w(), popupH);
-    browser->textsize(m_textsize);
-    browser->has_scrollbar(Fl_Browser_::VERTICAL);
+    m_browser = new Fl_Hold_Browser(0, 0, w, h);
+    m_browser->textsize(owner->m_textsize);
+    m_browser->has_scrollbar(Fl_Browser_::VERTICAL);
 
-    for (const auto& item : m_items) {
-        browser->add(item.c_str());
+    for (const auto& item : *m_items) {
+        m_browser->add(item.c_str());
     }
 
-    if (m_value >= 0 && m_value < (int)m_items.size()) {
-        browser->value(m_value + 1);
-        browser->middleline(m_value + 1);
+    if (owner->m_value >= 0 && owner->m_value < (int)owner->m_items->size()) {
+        m_browser->value(owner->m_value + 1);
+        m_browser->middleline(owner->m_value + 1);
     }
 
     // Use callback for selection - only trigger on release (click complete)
-    browser->when(FL_WHEN_RELEASE_ALWAYS);
-    browser->callback(popupCallback);
-
-    popup->end();
-    popup->show();
+    m_browser->when(FL_WHEN_RELEASE_ALWAYS);
+    m_browser->callback(browserCallback, this);
 
-    // Wait for initial mouse release before grabbing (avoids immediate close)
-    while (popup->shown() && Fl::event() != FL_RELEASE) {
-        Fl::wait(0.01);
-    }
-    Fl::wait(0.01);  // Process the release
-
-    // Now grab - any click outside will close the popup
-    if (popup->shown()) {
-        Fl::grab(popup);
-    }
+    end();
+}
 
-    // Run modal loop
-    while (popup->shown()) {
-        Fl::wait();
+void ScrollChoicePopup::browserCallback(Fl_Widget* w, void* data) {
+    Fl_Hold_Browser* browser = static_cast<Fl_Hold_Browser*>(w);
+    static_cast<ScrollChoicePopup*>(data)->finish(browser->value());
+}
 
-        // Check if clicked outside popup (grab sends events to popup)
-        if (Fl::event() == FL_PUSH) {
+int ScrollChoicePopup::handle(int event) {
+    switch (event) {
+        case FL_PUSH: {
+            // While grabbed we see every click; one outside the popup cancels
             int ex = Fl::event_x_root();
             int ey = Fl::event_y_root();
-            if (ex < popup->x() || ex >= popup->x() + popup->w() ||
-                ey < popup->y() || ey >= popup->y() + popup->h()) {
-                popup->hide();
+            if (ex < x() || ex >= x() + w() || ey < y() || ey >= y() + h()) {
+                finish(0);
+                return 1;
             }
+            m_sawPush = true;
+            break;
         }
+        case FL_RELEASE:
+            // Swallow the release of the click that opened us
+            if (!m_sawPush) return 1;
+            break;
+        case FL_KEYBOARD:
+            if (Fl::event_key() == FL_Escape) {
+                finish(0);
+                return 1;
+            }
+            break;
     }
+    return Fl_Menu_Window::handle(event);
+}
 
-    Fl::grab(nullptr);
-
-    // Get selection from user_data
-    int sel = static_cast<int>(reinterpret_cast<intptr_t>(popup->user_data()));
+void ScrollChoicePopup::finish(int selection) {
+    if (m_finished) return;
+    m_finished = true;
 
-    if (sel > 0) {
-        m_value = sel - 1;
-        redraw();
-        if (m_callback) {
-            m_callback(this, m_userdata);
-        }
+    if (Fl::grab() == this) {
+        Fl::grab(nullptr);
     }
+    hide();
 
-    delete popup;
-
-    // Reset cursor and hover state to avoid brief hand cursor flash
-    m_hover = false;
-    fl_cursor(FL_CURSOR_DEFAULT);
-}
+    if (m_owner) {
+        bool picked = selection > 0 && selection <= (int)m_items->size();
+        m_owner->popupClosed(picked ? &(*m_items)[selection - 1] : nullptr);
+    }
 
-// LogDisplay implementation
-LogDisplay::LogDisplay(int x, int y, int w, int h)
-    : Fl_Text_Display(x, y, w, h)
-    , m_gui(nullptr)
-{
+    // Deferred delete - we may be inside our own browser's callback
+    Fl::delete_widget(this);
 }
 
-void LogDisplay::checkScrollPosition() {
-    if (m_gui) {
-        if (isAtBottom()) {
-            m_gui->enableAutoScroll();
-        } else {
-            m_gui->disableAutoScroll();
-        }
-    }
-}
+void ScrollChoice::showPopup() {
+    if (m_items->empty() || m_popup) return;
 
-int LogDisplay::handle(int event) {
-    // Check if event is inside this widget
-    bool mouseInside = Fl::event_inside(this);
+    // Calculate popup height
+    int itemH = m_textsize + 6;
+    int popupH = (int)m_items->size() * itemH + 4;
+    if (popupH > m_maxHeight) popupH = m_maxHeight;
 
-    if (event == FL_MOUSEWHEEL) {
-        if (mouseInside) {
-            int result = Fl_Text_Display::handle(event);
-            checkScrollPosition();
-            return result;
-        }
-        return 0;  // Not inside - don't handle, let other widgets get it
+    // Convert widget coordinates to screen coordinates
+    int screenX = 0, screenY = 0;
+    Fl_Window* win = window();
+    if (win) {
+        screenX = win->x() + x();
+        screenY = win->y() + y();
     }
 
-    // Let parent handle the event first
-    int result = Fl_Text_Display::handle(event);
-
-    // Check scroll position after any mouse event that could affect scrolling
-    if (event == FL_PUSH || event == FL_RELEASE || event == FL_DRAG) {
-        checkScrollPosition();
+    // Create popup window over the widget (replacing it visually)
+    int popupY = screenY;
+    int screenH = Fl::h();
+    if (popupY + popupH > screenH) {
+        popupY = screenH - popupH;
+        if (popupY < 0) popupY = 0;
     }
 
-    return result;
+    // Show and grab, then return to the event loop straight away; the
+    // popup reports back through popupClosed()
+    m_popup = new ScrollChoicePopup(this, screenX, popupY, w(), popupH);
+    m_popup->show();
+    Fl::grab(m_popup);
 }
 
-void LogDisplay::scrollToBottom() {
-    if (buffer()) {
-        // Move cursor to end of buffer and scroll to show it
-        insert_position(buffer()->length());
-        show_insert_position();
-    }
-}
+void ScrollChoice::popupClosed(const std::string* picked) {
+    m_popup = nullptr;
 
-bool LogDisplay::isAtBottom() const {
-    if (!buffer()) return true;
+    // Reset cursor and hover state to avoid brief hand cursor flash
+    m_hover = false;
+    fl_cursor(FL_CURSOR_DEFAULT);
 
-    // Check if scrollbar is at or near the bottom
-    const Fl_Scrollbar* vsb = mVScrollBar;
-    if (vsb && vsb->visible()) {
-        // value() is current position, maximum() is max scroll,
-        // slider_size() is the visible portion
-        double maxScroll = vsb->maximum() - vsb->slider_size();
-        if (maxScroll <= 0) return true;  // Content fits, always "at bottom"
-        return (vsb->value() >= maxScroll - 1);  // Within 1 line of bottom
+    // The list may have been replaced while the popup was open; a pick
+    // that is no longer in it counts as a cancel
+    auto it = picked ? std::find(m_items->begin(), m_items->end(), *picked) : m_items->end();
+    if (it != m_items->end()) {
+        m_value = (int)(it - m_items->begin());
+        redraw();
+        if (m_callback) {
+            m_callback(this, m_userdata);
+        }
+    } else {
+        redraw();
     }
-    return true;  // No scrollbar means content fits
 }
 
 // PlaceholderInput implementation
@@ -339,6 +324,12 @@ PlaceholderInput::PlaceholderInput(int x, int y, int w, int h, const char* label
 }
 
 int PlaceholderInput::handle(int event) {
+    if (event == FL_PASTE && m_gui && strchr(Fl::event_text(), '\n')) {
+        // Multi-line paste (config block, ban list) goes straight to the
+        // command executor instead of being squashed into one line
+        m_gui->submitCommand(Fl::event_text());
+        return 1;
+    }
     if (event == FL_KEYDOWN && m_gui) {
         int key = Fl::event_key();
         if (key == FL_Up) {
@@ -384,29 +375,61 @@ FltkGUI::FltkGUI()
     , m_mapChoice(nullptr)
     , m_changeMapBtn(nullptr)
     , m_restartBtn(nullptr)
+    , m_budgetLabel(nullptr)
+    , m_execLabel(nullptr)
     , m_playersGroup(nullptr)
     , m_playerTable(nullptr)
     , m_logsGroup(nullptr)
-    , m_logDisplay(nullptr)
-    , m_logBuffer(nullptr)
+    , m_logView(nullptr)
     , m_autoScrollBtn(nullptr)
+    , m_historyBtn(nullptr)
+    , m_filterInput(nullptr)
+    , m_regexBtn(nullptr)
     , m_commandInput(nullptr)
     , m_initialized(false)
     , m_visible(false)
-    , m_playerCount(0)
-    , m_maxPlayers(0)
-    , m_entityCount(0)
+    , m_wantVisible(false)
+    , m_guiRunning(false)
+    , m_guiReady(false)
+    , m_droppedLogLines(0)
+    , m_logRateCvar(nullptr)
+    , m_logRate(-1)
+    , m_logMemoryCvar(nullptr)
+    , m_logMemoryBudget(DEFAULT_LOG_MEMORY)
+    , m_logMemoryUsed(0)
+    , m_logTextBytes(0)
+    , m_logLineCount(0)
+    , m_budgetCvar(nullptr)
+    , m_budgetUs(DEFAULT_BUDGET_US)
+    , m_frameBudget(m_frameStats)
+    , m_guiBudget(m_guiStats)
+    , m_startupDone(false)
+    , m_startupReported(false)
+    , m_guiStartUs(0)
     , m_serverTime(0)
-    , m_timeLimit(0)
+    , m_wakePending(false)
+    , m_forceSample(false)
+    , m_nextSampleTime(0)
+    , m_sampleCvar(nullptr)
+    , m_maps(std::make_shared<const std::vector<std::string>>())
+    , m_mapsVersion(0)
     , m_selectedMapIndex(0)
+    , m_logLines(DEFAULT_LOG_MEMORY)
+    , m_logLinesAdded(false)
     , m_autoScroll(true)
+    , m_showHistory(false)
+    , m_filtered(m_logLines)
+    , m_filterActive(false)
+    , m_filterError(false)
     , m_historyIndex(-1)
-    , m_origStdout(-1)
-    , m_origStderr(-1)
-    , m_captureActive(false)
+    , m_shownExecDone(0)
+    , m_shownExecTotal(0)
+    , m_sinkAnyPathCvar(nullptr)
+    , m_sinkAnyPath(-1)
 {
-    m_stdoutPipe[0] = m_stdoutPipe[1] = -1;
-    m_stderrPipe[0] = m_stderrPipe[1] = -1;
+    for (auto& phase : m_phaseUs) {
+        phase = 0;
+    }
 }
 
 FltkGUI::~FltkGUI() {
@@ -418,25 +441,153 @@ bool FltkGUI::initialize() {
         return true;
     }
 
-    Fl::scheme("gleam");
+    int64_t attachStart = nowUs();
 
-    setupOutputCapture();
+    // Engine calls are only safe here on the game thread, so grab what the
+    // GUI thread needs up front
+    char gameDir[256];
+    g_engfuncs.pfnGetGameDir(gameDir);
+    m_gameDir = gameDir;
+    m_budgetCvar = g_engfuncs.pfnCVarGetPointer("gui_frame_budget_us");
+    m_logRateCvar = g_engfuncs.pfnCVarGetPointer("gui_log_rate");
+    m_logMemoryCvar = g_engfuncs.pfnCVarGetPointer("gui_log_memory");
+    m_sampleCvar = g_engfuncs.pfnCVarGetPointer("gui_player_sample_ms");
+    m_sinkAnyPathCvar = g_engfuncs.pfnCVarGetPointer("gui_log_sink_any_path");
+    m_printLimiter.setOrigin(LogOrigin::ServerPrint);
+    m_eventLimiter.setOrigin(LogOrigin::GameEvent);
+    m_commandLimiter.setOrigin(LogOrigin::Command);
+    updateLogRate();
+
+    // Capture runs pass-through only until a GUI or a sink is there to
+    // read lines
+    m_capture.setLineQueueEnabled(false);
+    m_capture.setSinks(&m_sinks);
+    m_capture.start([this]() {
+        if (m_guiReady.load()) {
+            Fl::awake();
+        }
+    });
 
+    // No FLTK or X11 work happens here; the window is built on the first
+    // frame after show()
+    m_phaseUs[PHASE_ATTACH] = nowUs() - attachStart;
     m_initialized = true;
     return true;
 }
 
+bool FltkGUI::displayAvailable() {
+    const char* headless = getenv("METAMOD_GUI_HEADLESS");
+    if (headless && headless[0] && strcmp(headless, "0") != 0) {
+        return false;
+    }
+    const char* display = getenv("DISPLAY");
+    return display && display[0];
+}
+
+bool FltkGUI::startGuiThread() {
+    if (m_guiRunning) {
+        return true;
+    }
+    if (!displayAvailable()) {
+        return false;
+    }
+
+    // Map directory is scanned and watched off the game thread
+    m_mapIndex.start(m_gameDir + "/maps", [this]() {
+        if (m_guiReady.load()) {
+            Fl::awake();
+        }
+    });
+
+    m_capture.setLineQueueEnabled(true);
+    m_guiRunning = true;
+    m_guiStartUs = nowUs();
+    m_guiThread = std::thread(&FltkGUI::guiThreadMain, this);
+    return true;
+}
+
 void FltkGUI::shutdown() {
     if (!m_initialized) {
         return;
     }
 
-    hide();
-    cleanupOutputCapture();
+    m_wantVisible = false;
+    m_guiRunning = false;
+    wakeGui();
+    if (m_guiThread.joinable()) {
+        m_guiThread.join();
+    }
+    m_mapIndex.stop();
+    m_capture.stop();
+    m_sinks.stop();
 
     m_initialized = false;
 }
 
+void FltkGUI::guiThreadMain() {
+    int64_t t = nowUs();
+    m_phaseUs[PHASE_THREAD] = t - m_guiStartUs;
+
+    Fl::lock();  // Enables Fl::awake() from the game thread
+    Fl::scheme("gleam");
+    m_guiReady = true;
+    m_phaseUs[PHASE_DISPLAY] = nowUs() - t;
+
+    // History is best effort; without a writable gamedir the toggle stays off
+    m_spool.open(m_gameDir + "/addons/metamod-gui/spool");
+
+    m_search.start([this]() {
+        if (m_guiReady.load()) {
+            Fl::awake();
+        }
+    });
+
+    while (m_guiRunning.load()) {
+        bool wantVisible = m_wantVisible.load();
+        if (wantVisible && !m_window) {
+            bool firstWindow = !m_startupDone.load();
+
+            t = nowUs();
+            createWindow();
+            int64_t widgetsUs = nowUs() - t;
+
+            t = nowUs();
+            m_window->show();
+            Fl::flush();
+            m_visible = true;
+
+            if (firstWindow) {
+                m_phaseUs[PHASE_WIDGETS] = widgetsUs;
+                m_phaseUs[PHASE_FIRST_SHOW] = nowUs() - t;
+                m_startupDone = true;
+            }
+        } else if (!wantVisible && m_window) {
+            destroyWindow();
+            m_visible = false;
+        }
+
+        bool morePending = applyPendingEvents();
+
+        // Woken early by Fl::awake() when the game thread queues work;
+        // don't sleep if the last slice left work behind
+        Fl::wait(morePending ? 0.0 : 0.25);
+    }
+
+    destroyWindow();
+    m_visible = false;
+    m_search.stop();
+    m_spool.close();
+    m_guiReady = false;
+    Fl::unlock();
+}
+
+void FltkGUI::wakeGui() {
+    m_wakePending = false;
+    if (m_guiReady.load()) {
+        Fl::awake();
+    }
+}
+
 void FltkGUI::createWindow() {
     if (m_window) {
         return;
@@ -536,6 +687,16 @@ void FltkGUI::createWindow() {
         m_restartBtn->callback(onRestartBtn, this);
         m_restartBtn->labelsize(11);
         m_restartBtn->visible_focus(0);
+
+        // Progress of multi-line command batches
+        m_execLabel = new Fl_Box(controlsX + 95, btnY, controlsW - 103, btnH, "");
+        m_execLabel->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
+        m_execLabel->labelsize(11);
+
+        m_budgetLabel = new Fl_Box(controlsX + 8, btnY + btnH + 6, controlsW - 16, 14, "");
+        m_budgetLabel->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
+        m_budgetLabel->labelsize(10);
+        m_budgetLabel->labelcolor(fl_rgb_color(110, 110, 110));
     }
     m_controlsGroup->end();
 
@@ -550,8 +711,18 @@ void FltkGUI::createWindow() {
     m_playersGroup->labelfont(FL_HELVETICA_BOLD);
     {
         m_playerTable = new PlayerTable(margin + 4, playerPaneY + 18, playerPaneW - 8, playerPaneH - 22);
-        m_playerTable->setKickCallback([this](int idx) { doKickPlayer(idx); });
-        m_playerTable->setBanCallback([this](int idx) { doBanPlayer(idx); });
+        m_playerTable->setKickCallback([this](int idx) {
+            GuiCommand cmd;
+            cmd.type = GuiCommand::KickPlayer;
+            cmd.playerIndex = idx;
+            postCommand(std::move(cmd));
+        });
+        m_playerTable->setBanCallback([this](int idx) {
+            GuiCommand cmd;
+            cmd.type = GuiCommand::BanPlayer;
+            cmd.playerIndex = idx;
+            postCommand(std::move(cmd));
+        });
     }
     m_playersGroup->end();
 
@@ -566,28 +737,59 @@ void FltkGUI::createWindow() {
     m_logsGroup->labelsize(12);
     m_logsGroup->labelfont(FL_HELVETICA_BOLD);
     {
-        // Create text buffer and display for selectable/copyable text
-        m_logBuffer = new Fl_Text_Buffer();
         int scrollbarW = Fl::scrollbar_size();
         int btnSize = scrollbarW + 2;  // Button is 2px larger than scrollbar
         int displayW = logPaneW - 8;
-        int displayH = logPaneH - 22 - btnSize;  // Reduce height to make room for button row
-        m_logDisplay = new LogDisplay(margin + 4, logPaneY + 18, displayW, displayH);
-        m_logDisplay->setGui(this);
-        m_logDisplay->buffer(m_logBuffer);
-        m_logDisplay->textsize(11);
-        m_logDisplay->textfont(FL_COURIER);
-        m_logDisplay->wrap_mode(Fl_Text_Display::WRAP_AT_BOUNDS, 0);
+        int displayH = logPaneH - 26 - btnSize;  // Reduce height to make room for button row
+
+        // Filter box and regex toggle on the right of the pane's title row
+        int filterH = 18;
+        int filterW = logPaneW / 3;
+        int regexX = margin + 4 + displayW - btnSize;
+        m_filterInput = new PlaceholderInput(regexX - 2 - filterW, logPaneY + 2, filterW, filterH);
+        m_filterInput->setPlaceholder("Filter...");
+        m_filterInput->textsize(11);
+        m_filterInput->box(FL_BORDER_BOX);
+        m_filterInput->when(FL_WHEN_CHANGED);
+        m_filterInput->callback(onFilterChanged, this);
+        m_regexBtn = new HoverToggleButton(regexX, logPaneY + 2, btnSize, filterH, ".*");
+        m_regexBtn->callback(onFilterChanged, this);
+        m_regexBtn->labelsize(10);
+        m_regexBtn->tooltip("Regular expression");
+        m_regexBtn->visible_focus(0);
+
+        // Virtualized view over the log store; lines are selectable/copyable
+        m_logView = new LogView(margin + 4, logPaneY + 22, displayW, displayH);
+        m_logView->textsize(11);
+        m_logView->textfont(FL_COURIER);
+        m_logView->setScrollCallback([this](bool atBottom) {
+            if (atBottom) {
+                enableAutoScroll();
+            } else {
+                disableAutoScroll();
+            }
+        });
 
         // Auto-scroll toggle button in lower right corner, below the display
         int btnX = margin + 4 + displayW - btnSize;
-        int btnY = logPaneY + 18 + displayH;
+        int btnY = logPaneY + 22 + displayH;
         m_autoScrollBtn = new HoverToggleButton(btnX, btnY, btnSize, btnSize, "A");
         m_autoScrollBtn->value(1);  // Start with auto-scroll enabled
         m_autoScrollBtn->callback(onAutoScrollToggle, this);
         m_autoScrollBtn->labelsize(10);
         m_autoScrollBtn->tooltip("Auto-scroll");
         m_autoScrollBtn->visible_focus(0);
+
+        // History toggle to its left: page through the on-disk spool
+        m_historyBtn = new HoverToggleButton(btnX - btnSize - 2, btnY, btnSize, btnSize, "H");
+        m_historyBtn->value(m_showHistory ? 1 : 0);
+        m_historyBtn->callback(onHistoryToggle, this);
+        m_historyBtn->labelsize(10);
+        m_historyBtn->tooltip("History (Ctrl+PgUp/PgDn jumps an hour)");
+        m_historyBtn->visible_focus(0);
+        if (!m_spool.isOpen()) {
+            m_historyBtn->deactivate();
+        }
     }
     m_logsGroup->end();
 
@@ -604,12 +806,17 @@ void FltkGUI::createWindow() {
     m_window->end();
     m_window->resizable(m_logsGroup);
 
+    // Lines that arrived while the window was closed are already in the store.
+    // The filter does not survive the window, so start unfiltered.
+    m_filterActive = false;
+    m_filterError = false;
+    m_search.setQuery(std::string(), false);
+    updateLogSource();
+
     // Load data
-    loadMapCycle();
+    refreshMapList();
     refresh();
-
-    // Start refresh timer
-    Fl::add_timeout(1.0, onRefreshTimer, this);
+    selectCurrentMap();
 }
 
 void FltkGUI::destroyWindow() {
@@ -617,8 +824,6 @@ void FltkGUI::destroyWindow() {
         return;
     }
 
-    Fl::remove_timeout(onRefreshTimer, this);
-
     delete m_window;
     m_window = nullptr;
     m_titleBar = nullptr;
@@ -632,104 +837,464 @@ void FltkGUI::destroyWindow() {
     m_mapChoice = nullptr;
     m_changeMapBtn = nullptr;
     m_restartBtn = nullptr;
+    m_budgetLabel = nullptr;
+    m_execLabel = nullptr;
     m_playersGroup = nullptr;
     m_playerTable = nullptr;
     m_logsGroup = nullptr;
-    m_logDisplay = nullptr;
+    m_logView = nullptr;
     m_autoScrollBtn = nullptr;
-    // Note: m_logBuffer is owned by the text display and deleted with it
-    m_logBuffer = nullptr;
+    m_historyBtn = nullptr;
+    m_filterInput = nullptr;
+    m_regexBtn = nullptr;
+    m_logLinesAdded = false;
     m_commandInput = nullptr;
 }
 
-void FltkGUI::show() {
-    if (!m_initialized || m_visible) {
-        return;
+bool FltkGUI::show() {
+    if (!m_initialized) {
+        return false;
+    }
+    if (m_wantVisible) {
+        return true;
+    }
+    if (!displayAvailable()) {
+        return false;
     }
 
-    createWindow();
-    m_window->show();
-    m_visible = true;
+    // The GUI thread (display connection, widgets, map scan) is started
+    // from the next StartFrame so attach and console commands return fast
+    m_wantVisible = true;
+    m_forceSample = true;
+    wakeGui();
+    return true;
 }
 
 void FltkGUI::hide() {
-    if (!m_visible) {
+    if (!m_wantVisible) {
         return;
     }
 
-    destroyWindow();
-    m_visible = false;
+    m_wantVisible = false;
+    wakeGui();
+}
+
+void FltkGUI::onServerActivate() {
+    // New map loaded; push a fresh snapshot so the GUI reselects it
+    m_forceSample = true;
+    m_events.clear();
+    m_players.leaveAll();  // Back in through ClientPutInServer
 }
 
 void FltkGUI::processEvents() {
+    // The command line and server.cfg have run by the first frame; RCON
+    // can set the cvar later, but not lift the sink path confinement
+    if (m_sinkAnyPath < 0) {
+        m_sinkAnyPath = m_sinkAnyPathCvar && m_sinkAnyPathCvar->value != 0 ? 1 : 0;
+    }
     if (!m_initialized) {
         return;
     }
 
-    readCapturedOutput();
+    if (m_wantVisible && !m_guiRunning) {
+        startGuiThread();
+    }
+    if (!m_startupReported && m_startupDone.load(std::memory_order_acquire)) {
+        reportStartup();
+    }
 
-    if (!m_visible || !m_window) {
-        return;
+    int budgetUs = m_budgetCvar ? (int)m_budgetCvar->value : DEFAULT_BUDGET_US;
+    m_budgetUs.store(budgetUs, std::memory_order_relaxed);
+    m_frameBudget.begin(budgetUs);
+    updateLogRate();
+    if (m_logMemoryCvar && m_logMemoryCvar->value > 0) {
+        m_logMemoryBudget.store((size_t)m_logMemoryCvar->value, std::memory_order_relaxed);
     }
 
-    Fl::check();  // Process pending events
-}
+    // Repeat and suppression counts held back by the limiters
+    if (m_guiRunning.load(std::memory_order_relaxed) || m_sinks.active()) {
+        int64_t now = logClockUs();
+        for (LogLimiter* limiter : { &m_printLimiter, &m_eventLimiter, &m_commandLimiter }) {
+            LogOrigin origin = limiter->origin();
+            limiter->flush(now, [this, now, origin](std::string_view line) { queueLogLine(line, now, origin); });
+        }
+    }
 
-void FltkGUI::onRefreshTimer(void* data) {
-    FltkGUI* gui = static_cast<FltkGUI*>(data);
-    if (gui->m_visible && gui->m_window) {
-        gui->refresh();
-        Fl::repeat_timeout(1.0, onRefreshTimer, data);
+    // Take work queued by the GUI thread, bounded per frame. Whatever does
+    // not fit stays queued for the next frame.
+    GuiCommand cmd;
+    for (int i = 0; i < MAX_COMMANDS_PER_FRAME; i++) {
+        if (m_frameBudget.exhausted()) {
+            m_frameBudget.defer(m_commandQueue.size());
+            break;
+        }
+        if (!m_commandQueue.pop(cmd)) break;
+        runCommand(cmd);
+    }
+
+    // One ServerExecute per frame for everything that fits
+    if (m_executor.busy()) {
+        m_executor.runFrame(m_frameBudget);
+        m_wakePending = true;  // Progress changed
+    }
+
+    // Players are sampled every gui_player_sample_ms; the GUI gets a
+    // snapshot on the same tick, or at once when one is forced
+    double now = std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    bool tick = now >= m_nextSampleTime;
+    if (tick || (m_forceSample && m_wantVisible)) {
+        if (m_frameBudget.exhausted()) {
+            // Sampling walks every player; try again next frame
+            m_frameBudget.defer(1);
+        } else {
+            if (tick) {
+                samplePlayers();
+                int intervalMs = m_sampleCvar ? (int)m_sampleCvar->value : DEFAULT_SAMPLE_MS;
+                m_nextSampleTime = now + std::max(intervalMs, MIN_SAMPLE_MS) / 1000.0;
+            }
+            if (m_wantVisible) {
+                ServerSnapshot snapshot;
+                sampleServerState(snapshot);
+                if (m_snapshotQueue.push(std::move(snapshot))) {
+                    m_wakePending = true;
+                }
+                m_forceSample = false;
+            }
+        }
+    }
+
+    m_frameBudget.end();
+
+    if (m_wakePending) {
+        wakeGui();
     }
 }
 
-void FltkGUI::refresh() {
-    refreshServerStatus();
-    refreshPlayerList();
+void FltkGUI::printStats() {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "MetamodGUI: %s, budget %d us\n"
+             "  frames: %llu, over budget %llu, items deferred %llu\n"
+             "  gui passes: %llu, over budget %llu, items deferred %llu\n",
+             isHeadless() ? "headless" : (isVisible() ? "window open" : "window closed"),
+             m_budgetUs.load(),
+             (unsigned long long)m_frameStats.passes.load(),
+             (unsigned long long)m_frameStats.budgetHits.load(),
+             (unsigned long long)m_frameStats.deferred.load(),
+             (unsigned long long)m_guiStats.passes.load(),
+             (unsigned long long)m_guiStats.budgetHits.load(),
+             (unsigned long long)m_guiStats.deferred.load());
+    g_engfuncs.pfnServerPrint(buf);
+
+    snprintf(buf, sizeof(buf),
+             "  game events this map: %zu stored, %u kills, %u suicides, %u chat, %u connects, %u disconnects, %zu players\n",
+             m_events.size(),
+             m_events.total(GameEventType::Kill),
+             m_events.total(GameEventType::Suicide),
+             m_events.total(GameEventType::Say) + m_events.total(GameEventType::SayTeam),
+             m_events.total(GameEventType::Connect),
+             m_events.total(GameEventType::Disconnect),
+             m_events.playerCount());
+    g_engfuncs.pfnServerPrint(buf);
+
+    uint64_t logText = m_logTextBytes.load();
+    size_t logMemory = m_logMemoryUsed.load();
+    snprintf(buf, sizeof(buf),
+             "  log store: %llu lines, %.1f MB of text in %.1f of %.1f MB (%.1fx)\n",
+             (unsigned long long)m_logLineCount.load(),
+             logText / 1048576.0, logMemory / 1048576.0, m_logMemoryBudget.load() / 1048576.0,
+             logMemory > 0 ? (double)logText / logMemory : 0.0);
+    g_engfuncs.pfnServerPrint(buf);
+
+    // Per-source ingestion: admitted, collapsed as repeats, over the rate
+    const LogLimiter* limiters[] = {
+        &m_printLimiter, &m_eventLimiter, &m_capture.stdoutLimiter(), &m_capture.stderrLimiter(), &m_commandLimiter
+    };
+    for (size_t i = 0; i < sizeof(limiters) / sizeof(limiters[0]); i++) {
+        snprintf(buf, sizeof(buf), "  %s: %llu logged, %llu repeats collapsed, %llu suppressed\n",
+                 logOriginName((LogOrigin)i),
+                 (unsigned long long)limiters[i]->passed(),
+                 (unsigned long long)limiters[i]->collapsed(),
+                 (unsigned long long)limiters[i]->suppressed());
+        g_engfuncs.pfnServerPrint(buf);
+    }
+
+    for (const std::string& sink : m_sinks.describe()) {
+        snprintf(buf, sizeof(buf), "  sink %s\n", sink.c_str());
+        g_engfuncs.pfnServerPrint(buf);
+    }
+
+    if (m_startupDone) {
+        reportStartup();
+    }
 }
 
-void FltkGUI::refreshServerStatus() {
-    const char* hostname = g_engfuncs.pfnCVarGetString("hostname");
-    m_hostname = hostname ? hostname : "Unknown";
-    const char* mapname = gpGlobals ? STRING(gpGlobals->mapname) : nullptr;
-    m_currentMap = (mapname && mapname[0]) ? mapname : "Unknown";
-    m_maxPlayers = gpGlobals->maxClients;
-    m_serverTime = gpGlobals->time;
-    m_timeLimit = g_engfuncs.pfnCVarGetFloat("mp_timelimit");
-    m_entityCount = g_engfuncs.pfnNumberOfEntities();
+void FltkGUI::reportStartup() {
+    m_startupReported = true;
+
+    int64_t totalUs = 0;
+    for (int i = PHASE_THREAD; i < PHASE_COUNT; i++) {
+        totalUs += m_phaseUs[i].load();
+    }
+
+    char mapScan[32];
+    int64_t scanUs = m_mapIndex.scanUs();
+    if (scanUs > 0) {
+        snprintf(mapScan, sizeof(mapScan), "%.1f ms", scanUs / 1000.0);
+    } else {
+        snprintf(mapScan, sizeof(mapScan), "still running");
+    }
+
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "MetamodGUI: GUI ready in %.1f ms (attach %.1f, thread start %.1f, display %.1f, "
+             "widgets %.1f, first show %.1f ms; map scan %s)\n",
+             totalUs / 1000.0,
+             m_phaseUs[PHASE_ATTACH].load() / 1000.0,
+             m_phaseUs[PHASE_THREAD].load() / 1000.0,
+             m_phaseUs[PHASE_DISPLAY].load() / 1000.0,
+             m_phaseUs[PHASE_WIDGETS].load() / 1000.0,
+             m_phaseUs[PHASE_FIRST_SHOW].load() / 1000.0,
+             mapScan);
+    g_engfuncs.pfnServerPrint(buf);
+}
 
-    m_playerCount = 0;
+// Clients the hooks never saw: those connected before the plugin was
+// loaded, and bots the game DLL (bot_add) or another plugin puts in the
+// server by calling the game DLL directly. Only occupancy and userid are
+// read; the hooks still supply names and auth IDs for everyone else.
+void FltkGUI::reconcilePlayers() {
     for (int i = 1; i <= gpGlobals->maxClients; i++) {
         edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex(i);
+        int userid = 0;
         if (pEdict && !pEdict->free && pEdict->pvPrivateData) {
-            const char* name = STRING(pEdict->v.netname);
-            if (name && name[0]) m_playerCount++;
+            userid = g_engfuncs.pfnGetPlayerUserId(pEdict);
+        }
+
+        if (userid > 0) {
+            if (!m_players.tracks(i, userid)) {
+                onClientPutInServer(pEdict);
+            }
+        } else if (m_players.isInGame(i)) {
+            m_players.disconnect(i);
         }
     }
+}
+
+int FltkGUI::deathsOf(int index) const {
+    const PlayerInfo& row = m_players.row(index);
+    const EventStore::PlayerStats* stats = m_events.findPlayer(row.steamId, row.name);
+    return stats ? (int)stats->deaths : 0;
+}
+
+void FltkGUI::onClientConnect(edict_t* pEdict, const char* name) {
+    const char* authid = g_engfuncs.pfnGetPlayerAuthId(pEdict);
+    m_players.connect(g_engfuncs.pfnIndexOfEdict(pEdict), g_engfuncs.pfnGetPlayerUserId(pEdict),
+                      name ? name : "", authid ? authid : "");
+}
+
+void FltkGUI::onClientPutInServer(edict_t* pEdict) {
+    const char* name = STRING(pEdict->v.netname);
+    const char* authid = g_engfuncs.pfnGetPlayerAuthId(pEdict);
+    m_players.putInServer(g_engfuncs.pfnIndexOfEdict(pEdict), g_engfuncs.pfnGetPlayerUserId(pEdict),
+                          name ? name : "", authid ? authid : "");
+}
+
+void FltkGUI::onClientDisconnect(edict_t* pEdict) {
+    m_players.disconnect(g_engfuncs.pfnIndexOfEdict(pEdict));
+}
+
+void FltkGUI::onClientUserInfoChanged(edict_t* pEdict, char* infobuffer) {
+    const char* name = infobuffer ? g_engfuncs.pfnInfoKeyValue(infobuffer, "name") : nullptr;
+    if (name) {
+        m_players.rename(g_engfuncs.pfnIndexOfEdict(pEdict), name);
+    }
+}
+
+void FltkGUI::sampleServerState(ServerSnapshot& snapshot) {
+    const char* hostname = g_engfuncs.pfnCVarGetString("hostname");
+    snapshot.hostname = hostname ? hostname : "Unknown";
+    const char* mapname = gpGlobals ? STRING(gpGlobals->mapname) : nullptr;
+    snapshot.currentMap = mapname ? mapname : "";
+    snapshot.maxPlayers = gpGlobals->maxClients;
+    snapshot.serverTime = gpGlobals->time;
+    snapshot.timeLimit = g_engfuncs.pfnCVarGetFloat("mp_timelimit");
+    snapshot.entityCount = g_engfuncs.pfnNumberOfEntities();
+    m_serverTime = snapshot.serverTime;
+
+    m_players.rows(snapshot.players);
+    snapshot.playerCount = (int)snapshot.players.size();
+    snapshot.eventTotals = m_events.totals();
+}
+
+// One player sampling tick. Runs with or without a window, so the ping
+// history is already there when one is opened.
+void FltkGUI::samplePlayers() {
+    reconcilePlayers();
+
+    // Only clients in the game are visited; who they are is already known
+    for (int index : m_players.inGame()) {
+        edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex(index);
+        if (!pEdict || pEdict->free || !pEdict->pvPrivateData) continue;
+
+        if (m_players.authPending(index)) {
+            const char* authid = g_engfuncs.pfnGetPlayerAuthId(pEdict);
+            m_players.setAuthId(index, authid ? authid : "");
+        }
+
+        int ping = 0, loss = 0;
+        g_engfuncs.pfnGetPlayerStats(pEdict, &ping, &loss);
+        m_players.sample(index, ping, loss, (int)pEdict->v.health, (int)pEdict->v.frags, deathsOf(index));
+    }
+}
+
+bool FltkGUI::applyPendingEvents() {
+    m_guiBudget.begin(m_budgetUs.load(std::memory_order_relaxed));
+    bool morePending = false;
+
+    LogLine line;
+    while (m_logQueue.front(line)) {
+        addLogLine(line);
+        m_logQueue.pop();
+        if (m_guiBudget.exhausted()) {
+            m_guiBudget.defer(m_logQueue.size());
+            morePending = !m_logQueue.empty();
+            break;
+        }
+    }
+
+    // Captured stdout/stderr lines from the reader thread
+    while (!m_guiBudget.exhausted() && m_capture.peekLine(line)) {
+        addLogLine(line);
+        m_capture.popLine();
+    }
+    if (!m_capture.empty()) {
+        m_guiBudget.defer(m_capture.pending());
+        morePending = true;
+    }
+
+    unsigned dropped = m_droppedLogLines.exchange(0) + m_capture.takeDropped();
+    if (dropped > 0) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "(%u log lines dropped)", dropped);
+        addLogLine(buf);
+    }
+
+    // Everything gathered above reaches the display as one append
+    flushLogLines();
+    applySearchResults();
+
+    // Table and label redraws wait for a pass with time left
+    if (m_guiBudget.exhausted()) {
+        if (!m_snapshotQueue.empty()) {
+            m_guiBudget.defer(1);
+            morePending = true;
+        }
+    } else {
+        ServerSnapshot snapshot;
+        bool gotSnapshot = false;
+        while (m_snapshotQueue.pop(snapshot)) {
+            m_status = std::move(snapshot);
+            gotSnapshot = true;
+        }
+
+        if (gotSnapshot && m_window) {
+            refresh();
+            if (m_maps->empty() && !m_status.currentMap.empty()) {
+                refreshMapList();  // Fall back to the current map
+            }
+            if (m_status.currentMap != m_selectedForMap) {
+                selectCurrentMap();
+            }
+        }
+    }
+
+    // New map index snapshot published by the indexer thread
+    if (m_window && m_mapIndex.version() != m_mapsVersion) {
+        refreshMapList();
+    }
+
+    refreshCommandProgress();
+
+    m_guiBudget.end();
+    return morePending;
+}
+
+void FltkGUI::refreshCommandProgress() {
+    if (!m_execLabel) return;
+
+    unsigned done = m_executor.batchDone();
+    unsigned total = m_executor.batchTotal();
+    if (done == m_shownExecDone && total == m_shownExecTotal) return;
+    m_shownExecDone = done;
+    m_shownExecTotal = total;
+
+    if (total > 1 && done < total) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "Running commands: %u / %u", done, total);
+        m_execLabel->copy_label(buf);
+    } else {
+        m_execLabel->copy_label("");
+    }
+    m_execLabel->redraw();
+}
+
+void FltkGUI::postCommand(GuiCommand&& cmd) {
+    if (!m_commandQueue.push(std::move(cmd))) {
+        addLogLine("Command queue full, command dropped");
+    }
+}
+
+void FltkGUI::runCommand(const GuiCommand& cmd) {
+    switch (cmd.type) {
+        case GuiCommand::ServerCommand:
+            m_executor.enqueue(cmd.text);
+            break;
+        case GuiCommand::KickPlayer:
+            doKickPlayer(cmd.playerIndex);
+            break;
+        case GuiCommand::BanPlayer:
+            doBanPlayer(cmd.playerIndex);
+            break;
+        case GuiCommand::Quit:
+            m_executor.enqueue("quit\n");
+            break;
+    }
+}
+
+void FltkGUI::refresh() {
+    refreshServerStatus();
+    refreshPlayerList();
+}
+
+void FltkGUI::refreshServerStatus() {
+    const std::string& hostname = m_status.hostname;
 
     // Update labels
     if (m_hostnameLabel) {
         static char buf[128];
-        std::string host = m_hostname.length() > 28 ? m_hostname.substr(0, 25) + "..." : m_hostname;
+        std::string host = hostname.length() > 28 ? hostname.substr(0, 25) + "..." : hostname;
         snprintf(buf, sizeof(buf), "Host: %s", host.c_str());
         m_hostnameLabel->copy_label(buf);
     }
     if (m_mapLabel) {
         static char buf[64];
-        snprintf(buf, sizeof(buf), "Map: %s", m_currentMap.c_str());
+        snprintf(buf, sizeof(buf), "Map: %s",
+                 m_status.currentMap.empty() ? "Unknown" : m_status.currentMap.c_str());
         m_mapLabel->copy_label(buf);
     }
     if (m_playersLabel) {
         static char buf[64];
-        snprintf(buf, sizeof(buf), "Players: %d / %d", m_playerCount, m_maxPlayers);
+        snprintf(buf, sizeof(buf), "Players: %d / %d", m_status.playerCount, m_status.maxPlayers);
         m_playersLabel->copy_label(buf);
     }
     if (m_timeLabel) {
         static char buf[64];
-        int minutes = (int)(m_serverTime / 60);
-        int seconds = (int)m_serverTime % 60;
-        if (m_timeLimit > 0) {
-            snprintf(buf, sizeof(buf), "Time: %d:%02d / %.0f:00", minutes, seconds, m_timeLimit);
+        int minutes = (int)(m_status.serverTime / 60);
+        int seconds = (int)m_status.serverTime % 60;
+        if (m_status.timeLimit > 0) {
+            snprintf(buf, sizeof(buf), "Time: %d:%02d / %.0f:00", minutes, seconds, m_status.timeLimit);
         } else {
             snprintf(buf, sizeof(buf), "Time: %d:%02d", minutes, seconds);
         }
@@ -737,109 +1302,90 @@ void FltkGUI::refreshServerStatus() {
     }
     if (m_entitiesLabel) {
         static char buf[64];
-        snprintf(buf, sizeof(buf), "Entities: %d", m_entityCount);
+        snprintf(buf, sizeof(buf), "Entities: %d", m_status.entityCount);
         m_entitiesLabel->copy_label(buf);
     }
+    if (m_budgetLabel) {
+        static char buf[96];
+        snprintf(buf, sizeof(buf), "Frame budget %d us: %llu over, %llu deferred",
+                 m_budgetUs.load(),
+                 (unsigned long long)m_frameStats.budgetHits.load(),
+                 (unsigned long long)m_frameStats.deferred.load());
+        m_budgetLabel->copy_label(buf);
+    }
 
-    if (m_window) {
-        m_window->redraw();
+    // Just the labels; a window redraw would repaint the player table too
+    Fl_Box* labels[] = { m_hostnameLabel, m_mapLabel, m_playersLabel, m_timeLabel, m_entitiesLabel, m_budgetLabel };
+    for (Fl_Box* label : labels) {
+        if (label) label->redraw_label();
     }
 }
 
 void FltkGUI::refreshPlayerList() {
     if (!m_playerTable) return;
 
-    std::vector<PlayerInfo> players;
-
-    for (int i = 1; i <= gpGlobals->maxClients; i++) {
-        edict_t* pEdict = g_engfuncs.pfnPEntityOfEntIndex(i);
-        if (pEdict && !pEdict->free && pEdict->pvPrivateData) {
-            const char* name = STRING(pEdict->v.netname);
-            if (name && name[0]) {
-                PlayerInfo info;
-                info.index = i;
-                info.name = name;
-
-                int ping = 0, loss = 0;
-                g_engfuncs.pfnGetPlayerStats(pEdict, &ping, &loss);
-                info.ping = ping;
-                info.health = (int)pEdict->v.health;
-                info.frags = (int)pEdict->v.frags;
-
-                const char* authid = g_engfuncs.pfnGetPlayerAuthId(pEdict);
-                info.steamId = authid ? authid : "N/A";
-
-                players.push_back(info);
-            }
-        }
-    }
+    m_playerTable->setPlayers(m_status.players);
+    refreshEventCounts();
+}
 
-    m_playerTable->setPlayers(players);
+void FltkGUI::refreshEventCounts() {
+    if (!m_playersGroup || !m_window) return;
+
+    const EventStore::Totals& totals = m_status.eventTotals;
+    auto count = [&](GameEventType type) { return totals[(size_t)type]; };
+    char buf[128];
+    snprintf(buf, sizeof(buf), "Players  (this map: %u kills, %u chat, %u connects)",
+             count(GameEventType::Kill) + count(GameEventType::Suicide),
+             count(GameEventType::Say) + count(GameEventType::SayTeam),
+             count(GameEventType::Connect));
+    const char* shown = m_playersGroup->label();
+    if (shown && strcmp(shown, buf) == 0) return;
+
+    // Repaint the title strip only, not the table under it
+    m_playersGroup->copy_label(buf);
+    int titleH = m_playerTable ? m_playerTable->y() - m_playersGroup->y() : m_playersGroup->h();
+    m_window->damage(FL_DAMAGE_ALL, m_playersGroup->x(), m_playersGroup->y(), m_playersGroup->w(), titleH);
 }
 
-void FltkGUI::loadMapCycle() {
-    m_maps.clear();
-    m_selectedMapIndex = 0;
+void FltkGUI::refreshMapList() {
+    m_mapsVersion = m_mapIndex.version();
+    MapIndex::Snapshot maps = m_mapIndex.snapshot();
 
-    // Get game directory and build maps path
-    char gameDir[256];
-    g_engfuncs.pfnGetGameDir(gameDir);
-    char mapsPath[512];
-    snprintf(mapsPath, sizeof(mapsPath), "%s/maps", gameDir);
-
-    // Scan for .bsp files
-    DIR* dir = opendir(mapsPath);
-    if (dir) {
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != nullptr) {
-            const char* name = entry->d_name;
-            size_t len = strlen(name);
-
-            // Check for .bsp extension
-            if (len > 4 && strcasecmp(name + len - 4, ".bsp") == 0) {
-                // Extract map name without .bsp extension
-                char mapname[64];
-                size_t mapLen = len - 4;
-                if (mapLen >= sizeof(mapname)) mapLen = sizeof(mapname) - 1;
-                strncpy(mapname, name, mapLen);
-                mapname[mapLen] = '\0';
-
-                m_maps.push_back(mapname);
-            }
-        }
-        closedir(dir);
+    if (maps->empty() && !m_status.currentMap.empty()) {
+        maps = std::make_shared<const std::vector<std::string>>(1, m_status.currentMap);
     }
 
-    // Sort maps alphabetically
-    std::sort(m_maps.begin(), m_maps.end());
-
-    const char* currentMapName = gpGlobals ? STRING(gpGlobals->mapname) : nullptr;
-    if (currentMapName && !currentMapName[0]) {
-        currentMapName = nullptr;
+    // Keep the admin's pick across index updates
+    std::string selected;
+    if (m_selectedMapIndex >= 0 && m_selectedMapIndex < (int)m_maps->size()) {
+        selected = (*m_maps)[m_selectedMapIndex];
     }
 
-    if (m_maps.empty() && currentMapName) {
-        m_maps.push_back(currentMapName);
+    m_maps = std::move(maps);
+    m_selectedMapIndex = 0;
+    if (!selected.empty()) {
+        auto it = std::lower_bound(m_maps->begin(), m_maps->end(), selected);
+        if (it != m_maps->end() && *it == selected) {
+            m_selectedMapIndex = (int)(it - m_maps->begin());
+        }
     }
 
     // Populate dropdown
     if (m_mapChoice) {
-        m_mapChoice->clear();
-        for (size_t i = 0; i < m_maps.size(); i++) {
-            m_mapChoice->add(m_maps[i].c_str());
-        }
+        m_mapChoice->items(m_maps);
         m_mapChoice->value(m_selectedMapIndex);
     }
 }
 
 void FltkGUI::selectCurrentMap() {
-    if (!m_mapChoice || m_maps.empty()) return;
+    if (!m_mapChoice || m_maps->empty()) return;
 
-    const char* currentMapName = gpGlobals ? STRING(gpGlobals->mapname) : nullptr;
-    if (!currentMapName || !currentMapName[0]) return;
+    const char* currentMapName = m_status.currentMap.c_str();
+    if (!currentMapName[0]) return;
+    m_selectedForMap = m_status.currentMap;
 
-    for (int i = 0; i < (int)m_maps.size(); i++) {
-        if (strcasecmp(m_maps[i].c_str(), currentMapName) == 0) {
+    for (int i = 0; i < (int)m_maps->size(); i++) {
+        if (strcasecmp((*m_maps)[i].c_str(), currentMapName) == 0) {
             m_selectedMapIndex = i;
             m_mapChoice->value(m_selectedMapIndex);
             break;
@@ -879,9 +1425,11 @@ void FltkGUI::historyDown() {
 // Callbacks
 void FltkGUI::onWindowClose(Fl_Widget*, void* data) {
     FltkGUI* gui = static_cast<FltkGUI*>(data);
-    gui->hide();
-    g_engfuncs.pfnServerCommand("quit\n");
-    g_engfuncs.pfnServerExecute();
+    gui->m_wantVisible = false;
+
+    GuiCommand cmd;
+    cmd.type = GuiCommand::Quit;
+    gui->postCommand(std::move(cmd));
 }
 
 void FltkGUI::onChangeMapBtn(Fl_Widget*, void* data) {
@@ -904,6 +1452,100 @@ void FltkGUI::onAutoScrollToggle(Fl_Widget* w, void* data) {
     FltkGUI* gui = static_cast<FltkGUI*>(data);
     Fl_Toggle_Button* btn = static_cast<Fl_Toggle_Button*>(w);
     gui->m_autoScroll = btn->value() != 0;
+    if (gui->m_autoScroll && gui->m_logView) {
+        gui->m_logView->scrollToBottom();
+    }
+}
+
+void FltkGUI::onHistoryToggle(Fl_Widget* w, void* data) {
+    FltkGUI* gui = static_cast<FltkGUI*>(data);
+    Fl_Toggle_Button* btn = static_cast<Fl_Toggle_Button*>(w);
+    gui->m_showHistory = btn->value() != 0;
+    gui->updateLogSource();
+}
+
+void FltkGUI::onFilterChanged(Fl_Widget*, void* data) {
+    FltkGUI* gui = static_cast<FltkGUI*>(data);
+    if (!gui->m_filterInput || !gui->m_regexBtn) return;
+
+    std::string text = gui->m_filterInput->value();
+    bool regex = gui->m_regexBtn->value() != 0;
+    gui->m_search.setQuery(text, regex);
+
+    // Matches arrive asynchronously; an empty box goes back to the store now
+    if (text.empty() && gui->m_filterActive) {
+        gui->m_filterActive = false;
+        gui->m_filterError = false;
+        gui->updateLogSource();
+    }
+}
+
+// Points the view at the history spool, the filtered lines or the store,
+// and keeps the pane title and filter widgets in step
+void FltkGUI::updateLogSource() {
+    if (!m_logView) return;
+
+    char title[96];
+    if (m_showHistory) {
+        m_logView->setSource(&m_spool);
+        snprintf(title, sizeof(title), "Server Logs (history)");
+    } else if (m_filterActive) {
+        m_logView->setSource(&m_filtered);
+        if (m_filterError) {
+            snprintf(title, sizeof(title), "Server Logs (invalid filter)");
+        } else {
+            snprintf(title, sizeof(title), "Server Logs (%llu matches)",
+                     (unsigned long long)m_filtered.lineCount());
+        }
+    } else {
+        m_logView->setSource(&m_logLines);
+        snprintf(title, sizeof(title), "Server Logs");
+    }
+    m_logsGroup->copy_label(title);
+    m_logsGroup->redraw();
+
+    // The filter only applies to the in-memory lines
+    if (m_showHistory) {
+        m_filterInput->deactivate();
+        m_regexBtn->deactivate();
+    } else {
+        m_filterInput->activate();
+        m_regexBtn->activate();
+    }
+    m_filterInput->color(m_filterError ? fl_rgb_color(255, 220, 220) : FL_WHITE);
+    m_filterInput->redraw();
+
+    m_logView->scrollToBottom();
+    enableAutoScroll();
+}
+
+void FltkGUI::applySearchResults() {
+    SearchResults results;
+    if (!m_search.takeResults(results)) return;
+
+    if (results.reset) {
+        m_filtered.reset(results.seqs);
+        bool active = m_filterInput && m_filterInput->size() > 0;
+        if (active || m_filterActive) {
+            m_filterActive = active;
+            m_filterError = results.error;
+            updateLogSource();
+        }
+        return;
+    }
+
+    // Live follow: new matches among lines that just arrived
+    m_filtered.append(results.seqs);
+    if (m_filterActive && m_logView && !m_showHistory) {
+        m_logView->linesChanged();
+        if (m_autoScroll) {
+            m_logView->scrollToBottom();
+        }
+        char title[96];
+        snprintf(title, sizeof(title), "Server Logs (%llu matches)", (unsigned long long)m_filtered.lineCount());
+        m_logsGroup->copy_label(title);
+        m_logsGroup->redraw();
+    }
 }
 
 void FltkGUI::disableAutoScroll() {
@@ -922,24 +1564,26 @@ void FltkGUI::enableAutoScroll() {
 
 // Actions
 void FltkGUI::doChangeMap() {
-    if (m_maps.empty() || m_selectedMapIndex < 0 || m_selectedMapIndex >= (int)m_maps.size()) {
+    if (m_maps->empty() || m_selectedMapIndex < 0 || m_selectedMapIndex >= (int)m_maps->size()) {
         return;
     }
 
     char cmd[128];
-    snprintf(cmd, sizeof(cmd), "changelevel %s\n", m_maps[m_selectedMapIndex].c_str());
-    g_engfuncs.pfnServerCommand(cmd);
-    g_engfuncs.pfnServerExecute();
+    snprintf(cmd, sizeof(cmd), "changelevel %s\n", (*m_maps)[m_selectedMapIndex].c_str());
+    GuiCommand change;
+    change.text = cmd;
+    postCommand(std::move(change));
 
     char log[128];
-    snprintf(log, sizeof(log), "Changing map to: %s", m_maps[m_selectedMapIndex].c_str());
-    appendLog(log);
+    snprintf(log, sizeof(log), "Changing map to: %s", (*m_maps)[m_selectedMapIndex].c_str());
+    addLogLine(log);
 }
 
 void FltkGUI::doRestart() {
-    g_engfuncs.pfnServerCommand("restart\n");
-    g_engfuncs.pfnServerExecute();
-    appendLog("Map restarted");
+    GuiCommand restart;
+    restart.text = "restart\n";
+    postCommand(std::move(restart));
+    addLogLine("Map restarted");
 }
 
 void FltkGUI::doMapSelect() {
@@ -954,39 +1598,39 @@ void FltkGUI::doCommand() {
     const char* text = m_commandInput->value();
     if (!text || !text[0]) return;
 
-    std::string cmd = text;
+    submitCommand(text);
+
+    // Clear input
+    m_commandInput->value("");
+}
 
-    // Add to command history
-    if (m_commandHistory.empty() || m_commandHistory.back() != cmd) {
-        m_commandHistory.push_back(cmd);
-        if (m_commandHistory.size() > MAX_HISTORY) {
-            m_commandHistory.erase(m_commandHistory.begin());
+void FltkGUI::submitCommand(const std::string& cmd) {
+    size_t lineCount = std::count(cmd.begin(), cmd.end(), '\n');
+    if (!cmd.empty() && cmd.back() != '\n') lineCount++;
+
+    if (lineCount <= 1) {
+        // Add to command history
+        std::string entry = cmd.substr(0, cmd.find('\n'));
+        if (m_commandHistory.empty() || m_commandHistory.back() != entry) {
+            m_commandHistory.push_back(entry);
+            if (m_commandHistory.size() > MAX_HISTORY) {
+                m_commandHistory.erase(m_commandHistory.begin());
+            }
         }
+        addLogLine("> " + entry);
+    } else {
+        // Pasted batch; the executor spreads it over several frames
+        char more[48];
+        snprintf(more, sizeof(more), " (+%zu more lines)", lineCount - 1);
+        addLogLine("> " + cmd.substr(0, cmd.find('\n')) + more);
     }
     m_historyIndex = -1;
     m_savedInput.clear();
 
-    // Log the command
-    std::string logEntry = "> " + cmd + "\n";
-    m_logLines.push_back(logEntry);
-    while (m_logLines.size() > MAX_LOG_LINES) {
-        m_logLines.pop_front();
-    }
-
-    if (m_logBuffer) {
-        m_logBuffer->append(logEntry.c_str());
-        if (m_autoScroll && m_logDisplay) {
-            m_logDisplay->scrollToBottom();
-        }
-    }
-
-    // Execute
-    cmd += "\n";
-    g_engfuncs.pfnServerCommand(cmd.c_str());
-    g_engfuncs.pfnServerExecute();
-
-    // Clear input
-    m_commandInput->value("");
+    // Execute on the game thread
+    GuiCommand exec;
+    exec.text = cmd;
+    postCommand(std::move(exec));
 }
 
 void FltkGUI::doKickPlayer(int playerIndex) {
@@ -999,13 +1643,12 @@ void FltkGUI::doKickPlayer(int playerIndex) {
     const char* name = STRING(pEdict->v.netname);
     char cmd[128];
     snprintf(cmd, sizeof(cmd), "kick #%d\n", g_engfuncs.pfnGetPlayerUserId(pEdict));
-    g_engfuncs.pfnServerCommand(cmd);
-    g_engfuncs.pfnServerExecute();
+    m_executor.enqueue(cmd);
 
     char log[128];
     snprintf(log, sizeof(log), "Kicked: %s", name ? name : "Unknown");
     appendLog(log);
-    refresh();
+    m_forceSample = true;
 }
 
 void FltkGUI::doBanPlayer(int playerIndex) {
@@ -1020,140 +1663,142 @@ void FltkGUI::doBanPlayer(int playerIndex) {
 
     char cmd[128];
     snprintf(cmd, sizeof(cmd), "banid 0 #%d kick\n", userId);
-    g_engfuncs.pfnServerCommand(cmd);
-    g_engfuncs.pfnServerExecute();
-
-    g_engfuncs.pfnServerCommand("writeid\n");
-    g_engfuncs.pfnServerExecute();
+    m_executor.enqueue(cmd);
+    m_executor.enqueue("writeid\n");
 
     char log[128];
     snprintf(log, sizeof(log), "Banned: %s", name ? name : "Unknown");
     appendLog(log);
-    refresh();
+    m_forceSample = true;
 }
 
-void FltkGUI::appendLog(const char* text) {
-    if (!text || !text[0]) return;
-
-    char timestamped[512];
-    int minutes = (int)(m_serverTime / 60);
-    int seconds = (int)m_serverTime % 60;
-    snprintf(timestamped, sizeof(timestamped), "[%d:%02d] %s\n", minutes, seconds, text);
+LogLimiter& FltkGUI::limiterFor(LogOrigin origin) {
+    switch (origin) {
+        case LogOrigin::ServerPrint: return m_printLimiter;
+        case LogOrigin::GameEvent: return m_eventLimiter;
+        default: return m_commandLimiter;
+    }
+}
 
-    m_logLines.push_back(timestamped);
-    while (m_logLines.size() > MAX_LOG_LINES) {
-        m_logLines.pop_front();
+void FltkGUI::logSinkCommand(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        g_engfuncs.pfnServerPrint(
+            "Usage: gui_log_sink <file|json> <path> [max_mb=N] [keep=N] [backlog=N] [drop=oldest|newest]\n"
+            "       gui_log_sink socket <path> [format=plain|json] [backlog=N] [drop=oldest|newest]\n"
+            "       gui_log_sink syslog [path]\n"
+            "       gui_log_sink list | clear\n");
+        return;
     }
 
-    if (m_logBuffer && m_visible) {
-        m_logBuffer->append(timestamped);
-        if (m_autoScroll && m_logDisplay) {
-            m_logDisplay->scrollToBottom();
+    if (args[0] == "list") {
+        std::vector<std::string> sinks = m_sinks.describe();
+        if (sinks.empty()) {
+            g_engfuncs.pfnServerPrint("No log sinks\n");
+        }
+        for (const std::string& sink : sinks) {
+            g_engfuncs.pfnServerPrint(("  " + sink + "\n").c_str());
         }
+        return;
     }
-}
-
-void FltkGUI::setupOutputCapture() {
-    if (m_captureActive) return;
-
-    if (pipe(m_stdoutPipe) == -1) {
+    if (args[0] == "clear") {
+        m_sinks.clear();
+        g_engfuncs.pfnServerPrint("Log sinks removed\n");
         return;
     }
-    if (pipe(m_stderrPipe) == -1) {
-        close(m_stdoutPipe[0]);
-        close(m_stdoutPipe[1]);
-        m_stdoutPipe[0] = m_stdoutPipe[1] = -1;
+
+    std::string error;
+    bool anyPath = m_sinkAnyPath < 0 ? m_sinkAnyPathCvar && m_sinkAnyPathCvar->value != 0 : m_sinkAnyPath == 1;
+    std::unique_ptr<LogSink> sink = makeLogSink(args, m_gameDir, m_gameDir + "/addons/metamod-gui/logs", anyPath, error);
+    if (!sink) {
+        g_engfuncs.pfnServerPrint(("gui_log_sink: " + error + "\n").c_str());
         return;
     }
+    std::string added = "Log sink added: " + sink->describe() + "\n";
+    m_sinks.add(std::move(sink));
+    g_engfuncs.pfnServerPrint(added.c_str());
+}
 
-    m_origStdout = dup(STDOUT_FILENO);
-    m_origStderr = dup(STDERR_FILENO);
+void FltkGUI::updateLogRate() {
+    int rate = m_logRateCvar ? (int)m_logRateCvar->value : DEFAULT_LOG_RATE;
+    if (rate == m_logRate) return;
 
-    dup2(m_stdoutPipe[1], STDOUT_FILENO);
-    dup2(m_stderrPipe[1], STDERR_FILENO);
+    m_logRate = rate;
+    m_printLimiter.setRate(rate);
+    m_eventLimiter.setRate(rate);
+    m_commandLimiter.setRate(rate);
+    m_capture.setRateLimit(rate);
+}
 
-    int flags = fcntl(m_stdoutPipe[0], F_GETFL, 0);
-    fcntl(m_stdoutPipe[0], F_SETFL, flags | O_NONBLOCK);
+void FltkGUI::appendLog(std::string_view text, LogOrigin origin) {
+    if (text.empty()) return;
 
-    flags = fcntl(m_stderrPipe[0], F_GETFL, 0);
-    fcntl(m_stderrPipe[0], F_SETFL, flags | O_NONBLOCK);
+    // Headless with no sinks: nobody reads the line, skip the copy entirely
+    if (!m_guiRunning.load(std::memory_order_relaxed) && !m_sinks.active()) return;
 
-    m_captureActive = true;
+    // Stamped here, at ingest; the view formats the time when it draws the
+    // line. Floods stop at the limiter, before anything is copied or queued.
+    int64_t now = logClockUs();
+    limiterFor(origin).submit(text, now, [this, now, origin](std::string_view line) {
+        queueLogLine(line, now, origin);
+    });
 }
 
-void FltkGUI::cleanupOutputCapture() {
-    if (!m_captureActive) return;
-
-    if (m_origStdout != -1) {
-        dup2(m_origStdout, STDOUT_FILENO);
-        close(m_origStdout);
-        m_origStdout = -1;
-    }
-    if (m_origStderr != -1) {
-        dup2(m_origStderr, STDERR_FILENO);
-        close(m_origStderr);
-        m_origStderr = -1;
+// The copies on the game thread: straight into each reader's ring
+void FltkGUI::queueLogLine(std::string_view text, int64_t time, LogOrigin origin) {
+    if (m_sinks.active()) {
+        m_sinks.submit(LogSinkWriter::GAME, text, time, origin);
     }
+    if (!m_guiRunning.load(std::memory_order_relaxed)) return;
 
-    if (m_stdoutPipe[0] != -1) { close(m_stdoutPipe[0]); m_stdoutPipe[0] = -1; }
-    if (m_stdoutPipe[1] != -1) { close(m_stdoutPipe[1]); m_stdoutPipe[1] = -1; }
-    if (m_stderrPipe[0] != -1) { close(m_stderrPipe[0]); m_stderrPipe[0] = -1; }
-    if (m_stderrPipe[1] != -1) { close(m_stderrPipe[1]); m_stderrPipe[1] = -1; }
-
-    m_captureActive = false;
+    if (m_logQueue.push(text, time, origin)) {
+        m_wakePending = true;
+    } else {
+        m_droppedLogLines.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void FltkGUI::readCapturedOutput() {
-    if (!m_captureActive) return;
+void FltkGUI::appendGameEvent(std::string_view text) {
+    if (text.empty()) return;
 
-    char buffer[4096];
-    ssize_t bytesRead;
-    bool gotOutput = false;
+    // Counted even headless; gui_stats reports the totals
+    m_events.add(text, m_serverTime);
+    appendLog(text, LogOrigin::GameEvent);
+}
 
-    while ((bytesRead = read(m_stdoutPipe[0], buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytesRead] = '\0';
-        m_partialLine += buffer;
-        gotOutput = true;
-        // Pass through to original stdout
-        if (m_origStdout != -1) {
-            write(m_origStdout, buffer, bytesRead);
-        }
+void FltkGUI::addLogLine(const LogLine& line) {
+    if (LogBlockPtr sealed = m_logLines.push(line.text, line.time)) {
+        m_searchSealed.push_back(std::move(sealed));
     }
-
-    while ((bytesRead = read(m_stderrPipe[0], buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytesRead] = '\0';
-        m_partialLine += buffer;
-        gotOutput = true;
-        // Pass through to original stderr
-        if (m_origStderr != -1) {
-            write(m_origStderr, buffer, bytesRead);
-        }
+    if (m_spool.isOpen()) {
+        m_spool.append(line.text, line.time);
     }
 
-    if (gotOutput) {
-        size_t pos;
-        while ((pos = m_partialLine.find('\n')) != std::string::npos) {
-            std::string line = m_partialLine.substr(0, pos);
-            m_partialLine = m_partialLine.substr(pos + 1);
+    // The view and the search index only catch up on the next flushLogLines()
+    m_searchPending.emplace_back(line.text);
+    m_logLinesAdded = true;
+}
 
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
-            }
+void FltkGUI::addLogLine(std::string_view text) {
+    addLogLine(LogLine{ logClockUs(), text });
+}
 
-            if (line.empty()) continue;
+void FltkGUI::flushLogLines() {
+    if (!m_logLinesAdded) return;
+    m_logLinesAdded = false;
 
-            line += "\n";
-            m_logLines.push_back(line);
-            while (m_logLines.size() > MAX_LOG_LINES) {
-                m_logLines.pop_front();
-            }
+    m_logLines.setBudget(m_logMemoryBudget.load(std::memory_order_relaxed));
+    m_search.addLines(m_searchPending, m_searchSealed, m_logLines.firstSeq());
+    m_filtered.prune();
 
-            if (m_logBuffer && m_visible) {
-                m_logBuffer->append(line.c_str());
-                if (m_autoScroll && m_logDisplay) {
-                    m_logDisplay->scrollToBottom();
-                }
-            }
-        }
+    m_logMemoryUsed.store(m_logLines.memoryBytes(), std::memory_order_relaxed);
+    m_logTextBytes.store(m_logLines.textBytes(), std::memory_order_relaxed);
+    m_logLineCount.store(m_logLines.lineCount(), std::memory_order_relaxed);
+
+    // Filtered views move when matches arrive, not on every line
+    if (!m_logView || (m_filterActive && !m_showHistory)) return;
+
+    m_logView->linesChanged();
+    if (m_autoScroll) {
+        m_logView->scrollToBottom();
     }
 }
@@ -10,16 +10,35 @@
 #include <FL/Fl_Choice.H>
 #include <FL/Fl_Hold_Browser.H>
 #include <FL/Fl_Menu_Window.H>
-#include <FL/Fl_Text_Display.H>
-#include <FL/Fl_Text_Buffer.H>
 #include <FL/Fl_Input.H>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <deque>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <memory>
 #include <unistd.h>
 
 #include "player_table.hpp"
+#include "player_registry.hpp"
+#include "spsc_queue.hpp"
+#include "line_queue.hpp"
+#include "frame_budget.hpp"
+#include "output_capture.hpp"
+#include "log_limiter.hpp"
+#include "log_sink.hpp"
+#include "log_line.hpp"
+#include "command_executor.hpp"
+#include "map_index.hpp"
+#include "log_store.hpp"
+#include "log_view.hpp"
+#include "log_spool.hpp"
+#include "log_search.hpp"
+#include "game_events.hpp"
+
+struct cvar_s;
+struct edict_s;
 
 // Custom button with hover state
 class HoverButton : public Fl_Button {
@@ -41,15 +60,22 @@ private:
     bool m_hover;
 };
 
+class ScrollChoicePopup;
+
 // Custom choice with scrollable popup
 class ScrollChoice : public Fl_Widget {
 public:
+    // Shared, immutable item list (e.g. a MapIndex snapshot)
+    using ItemList = std::shared_ptr<const std::vector<std::string>>;
+
     ScrollChoice(int x, int y, int w, int h, const char* label = nullptr);
+    ~ScrollChoice();
     void add(const char* text);
     void clear();
+    void items(ItemList list);
     int value() const { return m_value; }
     void value(int v);
-    int size() const { return (int)m_items.size(); }
+    int size() const { return (int)m_items->size(); }
     const char* text() const;
     void textsize(int s) { m_textsize = s; }
     void callback(Fl_Callback* cb, void* data) { m_callback = cb; m_userdata = data; }
@@ -57,21 +83,71 @@ public:
     void draw() override;
     void maxHeight(int h) { m_maxHeight = h; }
 private:
+    friend class ScrollChoicePopup;
+
     void showPopup();
-    static void popupCallback(Fl_Widget* w, void* data);
+    void popupClosed(const std::string* picked);  // Null if cancelled
 
-    std::vector<std::string> m_items;
+    ItemList m_items;
     int m_value = 0;
     int m_textsize = 11;
     int m_maxHeight = 300;
     Fl_Callback* m_callback = nullptr;
     void* m_userdata = nullptr;
     bool m_hover = false;
+    ScrollChoicePopup* m_popup = nullptr;
+};
+
+// Event-driven popup list for ScrollChoice. Never runs its own event loop;
+// the selection (or cancel) is reported back through popupClosed(). Shows
+// the owner's list as it was when opened, which may be replaced meanwhile,
+// so the pick is reported as text.
+class ScrollChoicePopup : public Fl_Menu_Window {
+public:
+    ScrollChoicePopup(ScrollChoice* owner, int x, int y, int w, int h);
+    int handle(int event) override;
+    void detach() { m_owner = nullptr; }
+    void finish(int selection);
+private:
+    static void browserCallback(Fl_Widget* w, void* data);
+
+    ScrollChoice* m_owner;
+    ScrollChoice::ItemList m_items;
+    Fl_Hold_Browser* m_browser;
+    bool m_sawPush = false;
+    bool m_finished = false;
 };
 
 // Forward declaration
 class FltkGUI;
 
+// Work posted by the GUI thread for the game thread to run in StartFrame
+struct GuiCommand {
+    enum Type {
+        ServerCommand,  // text is a console command line
+        KickPlayer,     // playerIndex is an edict index
+        BanPlayer,      // playerIndex is an edict index
+        Quit
+    };
+
+    Type type = ServerCommand;
+    int playerIndex = 0;
+    std::string text;
+};
+
+// Server state sampled on the game thread and handed to the GUI thread
+struct ServerSnapshot {
+    std::string hostname;
+    std::string currentMap;
+    int playerCount = 0;
+    int maxPlayers = 0;
+    int entityCount = 0;
+    float serverTime = 0;
+    float timeLimit = 0;
+    std::vector<PlayerInfo> players;
+    EventStore::Totals eventTotals{};  // This map, from the game event log
+};
+
 // Custom input with placeholder text and command history
 class PlaceholderInput : public Fl_Input {
 public:
@@ -85,39 +161,42 @@ private:
     FltkGUI* m_gui = nullptr;
 };
 
-// Custom text display that detects manual scrolling
-class LogDisplay : public Fl_Text_Display {
-public:
-    LogDisplay(int x, int y, int w, int h);
-    int handle(int event) override;
-    void setGui(FltkGUI* gui) { m_gui = gui; }
-    void scrollToBottom();
-    bool isAtBottom() const;
-    void checkScrollPosition();
-private:
-    FltkGUI* m_gui;
-};
-
+// All FLTK work happens on a dedicated GUI thread. The game thread only
+// talks to it through the SPSC queues below: log lines and server snapshots
+// flow to the GUI, commands flow back and are run from StartFrame.
 class FltkGUI {
 public:
     static FltkGUI& getInstance();
 
+    // Game thread API
     bool initialize();
     void shutdown();
-    void show();
+    bool show();
     void hide();
     void processEvents();
-    bool isVisible() const { return m_visible; }
-
-    void appendLog(const char* text);
+    bool isVisible() const { return m_visible.load(std::memory_order_relaxed); }
+    bool isHeadless() const { return !m_guiRunning.load(std::memory_order_relaxed) && !m_wantVisible.load(std::memory_order_relaxed); }
+    void appendLog(std::string_view text, LogOrigin origin = LogOrigin::Command);
+    void appendGameEvent(std::string_view text);  // at_logged: parsed, then logged
+    void onServerActivate();
+    void onClientConnect(edict_s* pEdict, const char* name);
+    void onClientPutInServer(edict_s* pEdict);
+    void onClientDisconnect(edict_s* pEdict);
+    void onClientUserInfoChanged(edict_s* pEdict, char* infobuffer);
+    void printStats();
+    void logSinkCommand(const std::vector<std::string>& args);  // gui_log_sink
+
+    // GUI thread API (called from widgets)
     void disableAutoScroll();
     void enableAutoScroll();
-    void selectCurrentMap();
 
     // Command history navigation
     void historyUp();
     void historyDown();
 
+    // Run one or more newline-separated console commands
+    void submitCommand(const std::string& cmd);
+
 private:
     FltkGUI();
     ~FltkGUI();
@@ -127,11 +206,37 @@ private:
     void createWindow();
     void destroyWindow();
 
-    // Refresh callbacks
-    static void onRefreshTimer(void* data);
+    // GUI thread
+    void guiThreadMain();
+    bool applyPendingEvents();
+    void addLogLine(const LogLine& line);
+    void addLogLine(std::string_view text);  // Stamped now
+    void flushLogLines();
+    void applySearchResults();
+    void updateLogSource();
+    void postCommand(GuiCommand&& cmd);
+
+    // Game thread
+    bool startGuiThread();
+    static bool displayAvailable();
+    void wakeGui();
+    void reportStartup();
+    void queueLogLine(std::string_view text, int64_t time, LogOrigin origin);
+    LogLimiter& limiterFor(LogOrigin origin);
+    void updateLogRate();
+    void runCommand(const GuiCommand& cmd);
+    void sampleServerState(ServerSnapshot& snapshot);
+    void samplePlayers();
+    void reconcilePlayers();
+    int deathsOf(int index) const;
+
+    // Refresh widgets from the latest snapshot
     void refresh();
     void refreshServerStatus();
     void refreshPlayerList();
+    void refreshEventCounts();
+    void selectCurrentMap();
+    void refreshCommandProgress();
 
     // Widget callbacks
     static void onChangeMapBtn(Fl_Widget*, void* data);
@@ -140,8 +245,11 @@ private:
     static void onCommandInput(Fl_Widget*, void* data);
     static void onWindowClose(Fl_Widget*, void* data);
     static void onAutoScrollToggle(Fl_Widget*, void* data);
+    static void onHistoryToggle(Fl_Widget*, void* data);
+    static void onFilterChanged(Fl_Widget*, void* data);
 
-    // Actions
+    // Actions (GUI thread, except doKickPlayer/doBanPlayer which run on
+    // the game thread once their GuiCommand is drained)
     void doChangeMap();
     void doRestart();
     void doKickPlayer(int playerIndex);
@@ -149,13 +257,8 @@ private:
     void doMapSelect();
     void doCommand();
 
-    // Map loading
-    void loadMapCycle();
-
-    // stdout/stderr capture
-    void setupOutputCapture();
-    void cleanupOutputCapture();
-    void readCapturedOutput();
+    // Map list from the background index
+    void refreshMapList();
 
     // Window and widgets
     Fl_Double_Window* m_window;
@@ -176,6 +279,8 @@ private:
     ScrollChoice* m_mapChoice;
     HoverButton* m_changeMapBtn;
     HoverButton* m_restartBtn;
+    Fl_Box* m_budgetLabel;
+    Fl_Box* m_execLabel;
 
     // Players pane
     Fl_Group* m_playersGroup;
@@ -183,48 +288,133 @@ private:
 
     // Logs pane
     Fl_Group* m_logsGroup;
-    LogDisplay* m_logDisplay;
-    Fl_Text_Buffer* m_logBuffer;
+    LogView* m_logView;
     HoverToggleButton* m_autoScrollBtn;
+    HoverToggleButton* m_historyBtn;
+    PlaceholderInput* m_filterInput;
+    HoverToggleButton* m_regexBtn;
 
     // Command input
     PlaceholderInput* m_commandInput;
 
     // State
     bool m_initialized;
-    bool m_visible;
-
-    // Server status data
-    std::string m_hostname;
-    std::string m_currentMap;
-    int m_playerCount;
-    int m_maxPlayers;
-    int m_entityCount;
+    std::atomic<bool> m_visible;
+    std::atomic<bool> m_wantVisible;
+
+    // GUI thread
+    std::thread m_guiThread;
+    std::atomic<bool> m_guiRunning;
+    std::atomic<bool> m_guiReady;  // Fl::lock() done, Fl::awake() is safe
+
+    // Cross-thread queues
+    LineQueue<1 << 20, LogStore::MAX_LINE_BYTES> m_logQueue;  // game -> GUI
+    SpscQueue<ServerSnapshot, 8> m_snapshotQueue;  // game -> GUI
+    SpscQueue<GuiCommand, 256> m_commandQueue;     // GUI -> game
+    std::atomic<unsigned> m_droppedLogLines;
+
+    // Per-source gates in front of m_logQueue (game thread); the stdout
+    // and stderr ones belong to m_capture's reader thread
+    LogLimiter m_printLimiter;
+    LogLimiter m_eventLimiter;
+    LogLimiter m_commandLimiter;
+    cvar_s* m_logRateCvar;
+    int m_logRate;
+    static constexpr int DEFAULT_LOG_RATE = 200;  // Lines per second per source
+
+    // Log store memory budget (gui_log_memory), set by the game thread;
+    // usage is published back by the GUI thread for gui_stats
+    cvar_s* m_logMemoryCvar;
+    std::atomic<size_t> m_logMemoryBudget;
+    std::atomic<size_t> m_logMemoryUsed;
+    std::atomic<uint64_t> m_logTextBytes;
+    std::atomic<uint64_t> m_logLineCount;
+    static constexpr size_t DEFAULT_LOG_MEMORY = 16 * 1024 * 1024;
+    static constexpr int MAX_COMMANDS_PER_FRAME = 16;
+
+    // Per-pass time budgets (gui_frame_budget_us), game frame and GUI loop
+    cvar_s* m_budgetCvar;
+    std::atomic<int> m_budgetUs;
+    static constexpr int DEFAULT_BUDGET_US = 200;
+    FrameBudgetStats m_frameStats;
+    FrameBudgetStats m_guiStats;
+    FrameBudget m_frameBudget;
+    FrameBudget m_guiBudget;
+
+    // Startup phase timings in microseconds. Each is written by the thread
+    // that runs the phase and reported once from the game thread.
+    enum StartupPhase {
+        PHASE_ATTACH,      // initialize(): capture setup
+        PHASE_THREAD,      // First frame after show() -> GUI thread running
+        PHASE_DISPLAY,     // Fl::lock() + scheme, opens the X connection
+        PHASE_WIDGETS,     // createWindow()
+        PHASE_FIRST_SHOW,  // Window show + first flush, loads fonts
+        PHASE_COUNT
+    };
+    std::atomic<int64_t> m_phaseUs[PHASE_COUNT];
+    std::atomic<bool> m_startupDone;
+    bool m_startupReported;
+    int64_t m_guiStartUs;
+
+    // Game thread state
+    CommandExecutor m_executor;
     float m_serverTime;
-    float m_timeLimit;
-
-    // Map list
-    std::vector<std::string> m_maps;
+    bool m_wakePending;
+    bool m_forceSample;
+    double m_nextSampleTime;
+    cvar_s* m_sampleCvar;  // gui_player_sample_ms
+    static constexpr int DEFAULT_SAMPLE_MS = 1000;
+    static constexpr int MIN_SAMPLE_MS = 100;
+    std::string m_gameDir;
+    EventStore m_events;  // Typed at_logged events for the current map
+    PlayerRegistry m_players;  // Fed by the client hooks
+
+    // GUI thread copy of the last server snapshot
+    ServerSnapshot m_status;
+    std::string m_selectedForMap;
+
+    // Map list (GUI thread snapshot of m_mapIndex)
+    MapIndex m_mapIndex;
+    MapIndex::Snapshot m_maps;
+    uint64_t m_mapsVersion;
     int m_selectedMapIndex;
 
-    // Logs
-    std::deque<std::string> m_logLines;
-    static constexpr size_t MAX_LOG_LINES = 500;
+    // Logs (GUI thread). The view reads the store directly; lines added
+    // during a pass are shown by one flushLogLines().
+    LogStore m_logLines;
+    bool m_logLinesAdded;
     bool m_autoScroll;
 
-    // Command history
+    // On-disk history of every line (GUI thread); shown in place of the
+    // store while the history toggle is on
+    LogSpool m_spool;
+    bool m_showHistory;
+
+    // Filter over the store: the search thread shares its sealed blocks,
+    // filters them by trigram and streams matching sequence numbers back
+    LogSearch m_search;
+    FilteredLogSource m_filtered;
+    std::vector<std::string> m_searchPending;  // Lines for the next addLines()
+    std::vector<LogBlockPtr> m_searchSealed;   // Blocks sealed since then
+    bool m_filterActive;
+    bool m_filterError;
+
+    // Command history (GUI thread)
     std::vector<std::string> m_commandHistory;
     static constexpr size_t MAX_HISTORY = 30;
     int m_historyIndex;
     std::string m_savedInput;
+    unsigned m_shownExecDone;
+    unsigned m_shownExecTotal;
+
+    // Log sinks, fed by the game thread and the capture thread; declared
+    // first so they outlive the capture
+    LogSinkWriter m_sinks;
+    cvar_s* m_sinkAnyPathCvar;  // gui_log_sink_any_path
+    int m_sinkAnyPath;          // Latched on the first frame; -1 until then
 
-    // stdout/stderr capture
-    int m_stdoutPipe[2];
-    int m_stderrPipe[2];
-    int m_origStdout;
-    int m_origStderr;
-    bool m_captureActive;
-    std::string m_partialLine;
+    // stdout/stderr capture, drained on its own reader thread
+    OutputCapture m_capture;
 };
 
 #endif // FLTK_GUI_HPP
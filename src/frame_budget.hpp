@@ -0,0 +1,75 @@
+#ifndef FRAME_BUDGET_HPP
+#define FRAME_BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Counters shared with the GUI thread for display
+struct FrameBudgetStats {
+    std::atomic<uint64_t> passes{0};      // Budgeted passes run
+    std::atomic<uint64_t> budgetHits{0};  // Passes that ran out of time
+    std::atomic<uint64_t> deferred{0};    // Work items carried to a later pass
+};
+
+// Time budget for one pass of sliced work (a server frame, a GUI
+// iteration). Callers check exhausted() between work items and report
+// whatever they leave behind with defer().
+class FrameBudget {
+public:
+    explicit FrameBudget(FrameBudgetStats& stats) : m_stats(stats) {}
+
+    // budgetUs <= 0 disables the limit
+    void begin(int budgetUs) {
+        m_start = Clock::now();
+        m_budget = std::chrono::microseconds(budgetUs);
+        m_enabled = budgetUs > 0;
+        m_hit = false;
+    }
+
+    bool exhausted() {
+        if (!m_enabled) return false;
+        if (!m_hit && Clock::now() - m_start >= m_budget) {
+            m_hit = true;
+        }
+        return m_hit;
+    }
+
+    // For callers that stop early because the next item would not fit
+    void markExhausted() {
+        if (m_enabled) m_hit = true;
+    }
+
+    // Microseconds left in this pass; large when the limit is disabled
+    int64_t remainingUs() const {
+        if (!m_enabled) return INT64_MAX;
+        auto left = m_budget - (Clock::now() - m_start);
+        return std::chrono::duration_cast<std::chrono::microseconds>(left).count();
+    }
+
+    void defer(uint64_t items) {
+        if (items > 0) {
+            m_stats.deferred.fetch_add(items, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns true if the pass ran over budget
+    bool end() {
+        m_stats.passes.fetch_add(1, std::memory_order_relaxed);
+        if (m_hit) {
+            m_stats.budgetHits.fetch_add(1, std::memory_order_relaxed);
+        }
+        return m_hit;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    FrameBudgetStats& m_stats;
+    Clock::time_point m_start;
+    Clock::duration m_budget{0};
+    bool m_enabled = false;
+    bool m_hit = false;
+};
+
+#endif // FRAME_BUDGET_HPP
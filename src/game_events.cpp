@@ -0,0 +1,309 @@
+#include "game_events.hpp"
+#include <algorithm>
+#include <cstring>
+
+const char* gameEventTypeName(GameEventType type) {
+    static const char* names[] = {
+        "connect", "enter", "disconnect", "team", "rename", "kill",
+        "suicide", "attack", "say", "say_team", "triggered", "other"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)GameEventType::COUNT, "names out of date");
+    return names[(size_t)type];
+}
+
+static bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Parses the inside of a player token, "name<uid><authid><team>", from the
+// right so names containing '<' still work
+static bool parsePlayerToken(std::string_view token, LogPlayer& out) {
+    std::string_view fields[3];
+    size_t end = token.size();
+    for (int i = 2; i >= 0; i--) {
+        if (end == 0 || token[end - 1] != '>') return false;
+        size_t open = token.rfind('<', end - 1);
+        if (open == std::string_view::npos) return false;
+        fields[i] = token.substr(open + 1, end - 1 - (open + 1));
+        end = open;
+    }
+
+    int userid = 0;
+    if (fields[0].empty()) return false;
+    for (char c : fields[0]) {
+        if (c < '0' || c > '9') return false;
+        userid = userid * 10 + (c - '0');
+    }
+
+    out.name = token.substr(0, end);
+    out.userid = userid;
+    out.authid = fields[1];
+    out.team = fields[2];
+    return true;
+}
+
+// Reads a quoted player token at the start of text and returns the rest
+// after the closing quote, or npos
+static size_t parsePlayer(std::string_view text, LogPlayer& out) {
+    if (text.empty() || text[0] != '"') return std::string_view::npos;
+
+    // The token ends at the first >" that leaves a well-formed token
+    for (size_t close = text.find(">\"", 1); close != std::string_view::npos;
+         close = text.find(">\"", close + 1)) {
+        if (parsePlayerToken(text.substr(1, close), out)) {
+            return close + 2;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Text between the quote at text[0] and the next one
+static std::string_view quoted(std::string_view text) {
+    if (text.empty() || text[0] != '"') return std::string_view();
+    size_t close = text.find('"', 1);
+    return text.substr(1, (close == std::string_view::npos ? text.size() : close) - 1);
+}
+
+// Like quoted(), but up to the last quote: chat text may contain quotes
+static std::string_view quotedToEnd(std::string_view text) {
+    if (text.empty() || text[0] != '"') return std::string_view();
+    size_t close = text.rfind('"');
+    return text.substr(1, (close == 0 ? text.size() : close) - 1);
+}
+
+// ` with "weapon"` after a victim token
+static std::string_view withWeapon(std::string_view text) {
+    static constexpr std::string_view with = " with ";
+    return startsWith(text, with) ? quoted(text.substr(with.size())) : std::string_view();
+}
+
+bool parseGameEvent(std::string_view line, ParsedEvent& out) {
+    out = ParsedEvent();
+
+    // "L 10/17/2026 - 12:00:00: " is added by the engine's own log file,
+    // but accept it in case a plugin passes a full line through
+    if (startsWith(line, "L ") && line.size() > 25 && line.compare(23, 2, ": ") == 0) {
+        line.remove_prefix(25);
+    }
+
+    if (startsWith(line, "World triggered \"")) {
+        out.type = GameEventType::Triggered;
+        out.arg = quoted(line.substr(16));
+        return true;
+    }
+    if (startsWith(line, "Team \"")) {
+        size_t pos = line.find("\" triggered \"", 6);
+        if (pos == std::string_view::npos) return false;
+        out.type = GameEventType::Triggered;
+        out.actor.team = line.substr(6, pos - 6);
+        out.arg = quoted(line.substr(pos + 12));
+        return true;
+    }
+
+    size_t end = parsePlayer(line, out.actor);
+    if (end == std::string_view::npos) return false;
+    std::string_view rest = line.substr(end);
+    if (rest.empty() || rest[0] != ' ') {
+        out.type = GameEventType::Other;
+        return true;
+    }
+    rest.remove_prefix(1);
+
+    struct Verb {
+        std::string_view prefix;
+        GameEventType type;
+    };
+    static constexpr Verb verbs[] = {
+        { "killed ", GameEventType::Kill },
+        { "attacked ", GameEventType::Attack },
+        { "say \"", GameEventType::Say },
+        { "say_team \"", GameEventType::SayTeam },
+        { "triggered \"", GameEventType::Triggered },
+        { "committed suicide with \"", GameEventType::Suicide },
+        { "joined team \"", GameEventType::JoinTeam },
+        { "changed name to \"", GameEventType::ChangeName },
+        { "connected, address \"", GameEventType::Connect },
+        { "entered the game", GameEventType::EnterGame },
+        { "disconnected", GameEventType::Disconnect },
+    };
+
+    for (const Verb& verb : verbs) {
+        if (!startsWith(rest, verb.prefix)) continue;
+
+        // Arguments start at the opening quote, if the verb has one
+        std::string_view args = rest.substr(verb.prefix.size() - (verb.prefix.back() == '"' ? 1 : 0));
+        switch (verb.type) {
+            case GameEventType::Kill:
+            case GameEventType::Attack: {
+                size_t victimEnd = parsePlayer(args, out.target);
+                if (victimEnd == std::string_view::npos) return false;
+                out.arg = withWeapon(args.substr(victimEnd));
+                break;
+            }
+            case GameEventType::Say:
+            case GameEventType::SayTeam:
+                out.text = quotedToEnd(args);
+                break;
+            case GameEventType::EnterGame:
+            case GameEventType::Disconnect:
+                break;
+            default:
+                out.arg = quoted(args);
+                break;
+        }
+        out.type = verb.type;
+        return true;
+    }
+
+    // Player line outside the common verbs ("STEAM USERID validated", ...)
+    out.type = GameEventType::Other;
+    return true;
+}
+
+uint32_t StringPool::intern(std::string_view text) {
+    m_key.assign(text.data(), text.size());
+    auto it = m_ids.find(m_key);
+    if (it != m_ids.end()) return it->second;
+
+    uint32_t id = (uint32_t)m_strings.size();
+    m_strings.push_back(m_key);
+    m_ids.emplace(m_key, id);
+    return id;
+}
+
+void StringPool::clear() {
+    m_ids.clear();
+    m_strings.clear();
+}
+
+EventStore::EventStore() {
+    clear();
+}
+
+void EventStore::clear() {
+    m_type.clear();
+    m_time.clear();
+    m_actor.clear();
+    m_target.clear();
+    m_arg.clear();
+    m_args.clear();
+    m_args.intern(std::string_view());  // Id 0: no argument
+    m_playerIds.clear();
+    m_players.clear();
+    m_totals.fill(0);
+}
+
+// Auth ids shared by many players (bots, LAN, not yet validated) can't
+// tell players apart
+bool EventStore::isUniqueAuthId(std::string_view authid) {
+    if (startsWith(authid, "STEAM_ID_") || startsWith(authid, "VALVE_ID_")) return false;
+    return startsWith(authid, "STEAM_") || startsWith(authid, "VALVE_") || startsWith(authid, "[U:");
+}
+
+void EventStore::playerKey(std::string_view authid, std::string_view name, std::string& key) {
+    if (isUniqueAuthId(authid)) {
+        key.assign(authid.data(), authid.size());
+    } else {
+        key.assign("name:");
+        key.append(name.data(), name.size());
+    }
+}
+
+uint32_t EventStore::internPlayer(const LogPlayer& player) {
+    if (!player.valid()) return NO_PLAYER;
+
+    playerKey(player.authid, player.name, m_key);
+    auto it = m_playerIds.find(m_key);
+    if (it != m_playerIds.end()) {
+        PlayerStats& stats = m_players[it->second];
+        if (stats.name != player.name) {
+            stats.name.assign(player.name.data(), player.name.size());
+        }
+        if (!isUniqueAuthId(stats.authid) && isUniqueAuthId(player.authid)) {
+            stats.authid.assign(player.authid.data(), player.authid.size());
+        }
+        return it->second;
+    }
+
+    uint32_t id = (uint32_t)m_players.size();
+    PlayerStats stats;
+    stats.name.assign(player.name.data(), player.name.size());
+    stats.authid.assign(player.authid.data(), player.authid.size());
+    m_players.push_back(std::move(stats));
+    m_playerIds.emplace(m_key, id);
+    return id;
+}
+
+const EventStore::PlayerStats* EventStore::findPlayer(std::string_view authid, std::string_view name) const {
+    std::string key;
+    playerKey(authid, name, key);
+    auto it = m_playerIds.find(key);
+    return it != m_playerIds.end() ? &m_players[it->second] : nullptr;
+}
+
+void EventStore::add(std::string_view line, float time) {
+    ParsedEvent event;
+    parseGameEvent(line, event);
+
+    uint32_t actor = internPlayer(event.actor);
+    uint32_t target = internPlayer(event.target);
+
+    switch (event.type) {
+        case GameEventType::Connect:
+            if (actor != NO_PLAYER) m_players[actor].connects++;
+            break;
+        case GameEventType::Kill:
+            if (actor != NO_PLAYER) {
+                m_players[actor].kills++;
+                if (!event.actor.team.empty() && event.actor.team == event.target.team) {
+                    m_players[actor].teamKills++;
+                }
+            }
+            if (target != NO_PLAYER) m_players[target].deaths++;
+            break;
+        case GameEventType::Suicide:
+            if (actor != NO_PLAYER) {
+                m_players[actor].suicides++;
+                m_players[actor].deaths++;
+            }
+            break;
+        case GameEventType::Say:
+        case GameEventType::SayTeam:
+            if (actor != NO_PLAYER) m_players[actor].chat++;
+            break;
+        case GameEventType::ChangeName:
+            // Name-keyed players (bots, LAN) keep their stats under the new name
+            if (actor != NO_PLAYER && !isUniqueAuthId(event.actor.authid)) {
+                playerKey(event.actor.authid, event.arg, m_key);
+                m_playerIds.emplace(m_key, actor);
+            }
+            if (actor != NO_PLAYER) {
+                m_players[actor].name.assign(event.arg.data(), event.arg.size());
+            }
+            break;
+        default:
+            break;
+    }
+    m_totals[(size_t)event.type]++;
+
+    if (m_type.size() >= MAX_EVENTS) {
+        dropOldest();
+    }
+    m_type.push_back((uint8_t)event.type);
+    m_time.push_back(time);
+    m_actor.push_back(actor);
+    m_target.push_back(target);
+    // Chat text stays in the log; only short, repeating arguments are interned
+    bool internArg = event.type != GameEventType::Connect && event.type != GameEventType::ChangeName;
+    m_arg.push_back(internArg ? m_args.intern(event.arg) : 0);
+}
+
+// Keeps the newer half; totals and player aggregates are unaffected
+void EventStore::dropOldest() {
+    size_t drop = m_type.size() / 2;
+    m_type.erase(m_type.begin(), m_type.begin() + drop);
+    m_time.erase(m_time.begin(), m_time.begin() + drop);
+    m_actor.erase(m_actor.begin(), m_actor.begin() + drop);
+    m_target.erase(m_target.begin(), m_target.begin() + drop);
+    m_arg.erase(m_arg.begin(), m_arg.begin() + drop);
+}
@@ -0,0 +1,135 @@
+#ifndef GAME_EVENTS_HPP
+#define GAME_EVENTS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Game events in the standard HL log grammar, as passed to
+// pfnAlertMessage(at_logged, ...) by the game DLL
+enum class GameEventType : uint8_t {
+    Connect,     // "P" connected, address "ip:port"
+    EnterGame,   // "P" entered the game
+    Disconnect,  // "P" disconnected
+    JoinTeam,    // "P" joined team "T"
+    ChangeName,  // "P" changed name to "N"
+    Kill,        // "P" killed "V" with "weapon"
+    Suicide,     // "P" committed suicide with "weapon"
+    Attack,      // "P" attacked "V" with "weapon" (damage ...)
+    Say,         // "P" say "text"
+    SayTeam,     // "P" say_team "text"
+    Triggered,   // "P" triggered "action", World/Team triggered "action"
+    Other,       // Anything else (cvars, log file notices, ...)
+    COUNT
+};
+
+const char* gameEventTypeName(GameEventType type);
+
+// A "name<uid><authid><team>" token; views into the parsed line
+struct LogPlayer {
+    std::string_view name;
+    std::string_view authid;
+    std::string_view team;
+    int userid = -1;
+    bool valid() const { return userid >= 0; }
+};
+
+struct ParsedEvent {
+    GameEventType type = GameEventType::Other;
+    LogPlayer actor;
+    LogPlayer target;       // Kill and Attack victim
+    std::string_view arg;   // Weapon, team, new name or action
+    std::string_view text;  // Chat text
+};
+
+// Single pass over one log message; the result points into line. Accepts
+// the message with or without the "L mm/dd/yyyy - hh:mm:ss: " prefix.
+// Returns false (type Other) for lines outside the grammar.
+bool parseGameEvent(std::string_view line, ParsedEvent& out);
+
+// Append-only string table; ids are dense and stable until clear()
+class StringPool {
+public:
+    uint32_t intern(std::string_view text);
+    std::string_view str(uint32_t id) const { return m_strings[id]; }
+    size_t size() const { return m_strings.size(); }
+    void clear();
+
+private:
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<std::string> m_strings;
+    std::string m_key;  // Reused lookup key
+};
+
+// Typed events for the current map, stored column by column: event type,
+// server time, actor and target player ids, and an interned argument.
+// Players are interned by auth id (by name for bots and LAN ids) and carry
+// running aggregates, so totals and per-player numbers never re-scan text.
+// Game thread only.
+class EventStore {
+public:
+    struct PlayerStats {
+        std::string name;    // Latest name seen
+        std::string authid;
+        uint32_t kills = 0;
+        uint32_t deaths = 0;
+        uint32_t suicides = 0;
+        uint32_t teamKills = 0;
+        uint32_t chat = 0;
+        uint32_t connects = 0;
+    };
+
+    using Totals = std::array<uint32_t, (size_t)GameEventType::COUNT>;
+
+    static constexpr uint32_t NO_PLAYER = UINT32_MAX;
+
+    EventStore();
+
+    // Parses and records one at_logged message
+    void add(std::string_view line, float time);
+    void clear();
+
+    size_t size() const { return m_type.size(); }
+    GameEventType type(size_t row) const { return (GameEventType)m_type[row]; }
+    float time(size_t row) const { return m_time[row]; }
+    uint32_t actor(size_t row) const { return m_actor[row]; }
+    uint32_t target(size_t row) const { return m_target[row]; }
+    std::string_view arg(size_t row) const { return m_args.str(m_arg[row]); }
+
+    // Counts since clear(), including rows already dropped from the columns
+    const Totals& totals() const { return m_totals; }
+    uint32_t total(GameEventType type) const { return m_totals[(size_t)type]; }
+
+    size_t playerCount() const { return m_players.size(); }
+    const PlayerStats& player(uint32_t id) const { return m_players[id]; }
+    const PlayerStats* findPlayer(std::string_view authid, std::string_view name) const;
+
+private:
+    uint32_t internPlayer(const LogPlayer& player);
+    static bool isUniqueAuthId(std::string_view authid);
+    static void playerKey(std::string_view authid, std::string_view name, std::string& key);
+    void dropOldest();
+
+    // Columns, one entry per event
+    std::vector<uint8_t> m_type;
+    std::vector<float> m_time;
+    std::vector<uint32_t> m_actor;
+    std::vector<uint32_t> m_target;
+    std::vector<uint32_t> m_arg;
+
+    StringPool m_args;  // Weapons, teams, actions
+
+    // Auth id, or "name:" + name, to an index in m_players
+    std::unordered_map<std::string, uint32_t> m_playerIds;
+    std::vector<PlayerStats> m_players;
+    Totals m_totals;
+    std::string m_key;
+
+    static constexpr size_t MAX_EVENTS = 1 << 20;  // Oldest half dropped past this
+};
+
+#endif // GAME_EVENTS_HPP
@@ -0,0 +1,131 @@
+#ifndef LINE_QUEUE_HPP
+#define LINE_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "log_line.hpp"
+
+// Bounded lock-free single-producer/single-consumer queue of log lines,
+// stored as variable-length records in one byte ring. push() copies the
+// text straight into the ring (no allocation, no formatting); the consumer
+// reads it in place and releases it with pop(). A record never wraps: if it
+// does not fit before the end of the ring, the producer leaves a skip marker
+// there and starts again at the front. Lines up to MaxLine bytes are kept
+// whole; longer ones are cut at MaxLine.
+template <size_t Capacity, size_t MaxLine>
+class LineQueue {
+    static_assert(Capacity >= 64 && (Capacity & (Capacity - 1)) == 0,
+                  "LineQueue capacity must be a power of two");
+    static_assert(MaxLine * 4 <= Capacity, "LineQueue must hold several of its longest lines");
+
+public:
+    LineQueue() : m_head(0), m_popped(0), m_tail(0), m_pushed(0) {}
+    LineQueue(const LineQueue&) = delete;
+    LineQueue& operator=(const LineQueue&) = delete;
+
+    // Producer side. Returns false if the ring has no room for the line.
+    bool push(std::string_view text, int64_t time, LogOrigin origin) {
+        if (text.size() > MaxLine) {
+            text = text.substr(0, MaxLine);
+        }
+        size_t need = recordBytes(text.size());
+
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        size_t offset = (size_t)(tail & MASK);
+        size_t skip = Capacity - offset < need ? Capacity - offset : 0;
+        if (Capacity - (size_t)(tail - head) < skip + need) {
+            return false;
+        }
+
+        if (skip > 0) {
+            writeHeader(offset, SKIP, 0, 0);
+            offset = 0;
+        }
+        writeHeader(offset, (uint32_t)text.size(), (uint32_t)origin, time);
+        memcpy(m_data + offset + HEADER_BYTES, text.data(), text.size());
+
+        m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_tail.store(tail + skip + need, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Views the oldest line without removing it; the view
+    // stays valid until pop(). Returns false if empty.
+    bool front(LogLine& out) {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        if (head == tail) return false;
+
+        Header header = readHeader((size_t)(head & MASK));
+        if (header.length == SKIP) {
+            head += Capacity - (size_t)(head & MASK);
+            m_head.store(head, std::memory_order_release);
+            header = readHeader(0);
+        }
+        out.time = header.time;
+        out.origin = (LogOrigin)header.origin;
+        out.text = std::string_view(m_data + (head & MASK) + HEADER_BYTES, header.length);
+        return true;
+    }
+
+    // Releases the line front() returned
+    void pop() {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        Header header = readHeader((size_t)(head & MASK));
+        m_popped.store(m_popped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_head.store(head + recordBytes(header.length), std::memory_order_release);
+    }
+
+    // Approximate, as for SpscQueue
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        uint64_t popped = m_popped.load(std::memory_order_relaxed);
+        uint64_t pushed = m_pushed.load(std::memory_order_relaxed);
+        return pushed > popped ? (size_t)(pushed - popped) : 0;
+    }
+
+private:
+    struct Header {
+        uint32_t length;
+        uint32_t origin;
+        int64_t time;
+    };
+
+    static constexpr size_t HEADER_BYTES = sizeof(Header);
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr uint32_t SKIP = UINT32_MAX;  // Rest of the ring is unused
+
+    // Records start on header-size boundaries, so a skip marker always fits
+    static size_t recordBytes(size_t length) {
+        return (HEADER_BYTES + length + HEADER_BYTES - 1) & ~(HEADER_BYTES - 1);
+    }
+
+    void writeHeader(size_t offset, uint32_t length, uint32_t origin, int64_t time) {
+        Header header = { length, origin, time };
+        memcpy(m_data + offset, &header, sizeof(header));
+    }
+
+    Header readHeader(size_t offset) const {
+        Header header;
+        memcpy(&header, m_data + offset, sizeof(header));
+        return header;
+    }
+
+    alignas(64) char m_data[Capacity];
+
+    // Byte positions, which only grow, and line counts for size()
+    alignas(64) std::atomic<uint64_t> m_head;  // Consumer
+    std::atomic<uint64_t> m_popped;
+    alignas(64) std::atomic<uint64_t> m_tail;  // Producer
+    std::atomic<uint64_t> m_pushed;
+};
+
+#endif // LINE_QUEUE_HPP
@@ -0,0 +1,79 @@
+#include "line_splitter.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINE_SPLITTER_X86 1
+#include <immintrin.h>
+#endif
+
+static const char* findNewlineScalar(const char* p, const char* end) {
+    const void* hit = memchr(p, '\n', end - p);
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+#ifdef LINE_SPLITTER_X86
+// Both vector paths are compiled with per-function target attributes so the
+// plugin itself can still be built for a baseline (-m32, no -msse2) CPU
+
+__attribute__((target("sse2")))
+static const char* findNewlineSse2(const char* p, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return findNewlineScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* findNewlineAvx2(const char* p, const char* end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findNewlineScalar(p, end);
+}
+#endif
+
+namespace {
+
+using FindNewlineFn = const char* (*)(const char*, const char*);
+
+struct NewlineSearch {
+    FindNewlineFn fn;
+    const char* name;
+};
+
+NewlineSearch selectNewlineSearch() {
+#ifdef LINE_SPLITTER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { findNewlineAvx2, "avx2" };
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return { findNewlineSse2, "sse2" };
+    }
+#endif
+    return { findNewlineScalar, "scalar" };
+}
+
+const NewlineSearch g_newlineSearch = selectNewlineSearch();
+
+} // namespace
+
+const char* findNewline(const char* begin, const char* end) {
+    return g_newlineSearch.fn(begin, end);
+}
+
+const char* newlineSearchImpl() {
+    return g_newlineSearch.name;
+}
@@ -0,0 +1,33 @@
+#ifndef LINE_SPLITTER_HPP
+#define LINE_SPLITTER_HPP
+
+#include <cstddef>
+#include <string_view>
+
+// Returns the first '\n' in [begin, end), or end if there is none.
+// Uses AVX2 or SSE2 when the CPU has them, memchr otherwise.
+const char* findNewline(const char* begin, const char* end);
+
+// Name of the implementation picked at load time ("avx2", "sse2", "scalar")
+const char* newlineSearchImpl();
+
+// Calls onLine(std::string_view) for each '\n'-terminated line in
+// [data, data + len), without the '\n'. Bytes before scanFrom are known to
+// hold no newline and are not searched again. Returns the number of bytes
+// consumed, i.e. the offset just past the last '\n' (0 if there was none).
+template <typename OnLine>
+size_t splitLines(const char* data, size_t len, size_t scanFrom, OnLine&& onLine) {
+    const char* end = data + len;
+    const char* lineStart = data;
+    const char* p = data + scanFrom;
+
+    const char* nl;
+    while ((nl = findNewline(p, end)) != end) {
+        onLine(std::string_view(lineStart, nl - lineStart));
+        lineStart = nl + 1;
+        p = lineStart;
+    }
+    return lineStart - data;
+}
+
+#endif // LINE_SPLITTER_HPP
@@ -0,0 +1,148 @@
+#ifndef LOG_LIMITER_HPP
+#define LOG_LIMITER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "log_line.hpp"
+
+// Gate for one log source, run on the thread that produces its lines.
+// Consecutive identical lines collapse into one "(repeated N times)"
+// notice, and what is left goes through a token bucket of rate lines per
+// second (bursts up to BURST_SECONDS worth). Dropped lines are counted
+// and reported as notices, so a flood costs a compare per line and still
+// shows up in the log. The counters can be read from any thread.
+class LogLimiter {
+public:
+    LogLimiter() = default;
+    LogLimiter(const LogLimiter&) = delete;
+    LogLimiter& operator=(const LogLimiter&) = delete;
+
+    void setOrigin(LogOrigin origin) { m_origin = origin; }
+    LogOrigin origin() const { return m_origin; }
+
+    // Lines per second; 0 disables the bucket (collapsing stays on)
+    void setRate(int linesPerSec) { m_rate.store(linesPerSec < 0 ? 0 : linesPerSec, std::memory_order_relaxed); }
+
+    // Calls emit(std::string_view) for the line if it passes, preceded by
+    // any notices it makes due. Returns whether the line itself was emitted.
+    template <typename Emit>
+    bool submit(std::string_view line, int64_t nowUs, Emit&& emit) {
+        if (m_haveLast && line == m_last) {
+            // Repeats of a line the bucket refused stay refused
+            if (m_lastPassed) {
+                m_repeats++;
+                m_collapsed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                m_dropped++;
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            }
+            markPending(nowUs);
+            return false;
+        }
+
+        emitRepeats(emit);
+        m_last.assign(line.data(), line.size());
+        m_haveLast = true;
+
+        m_lastPassed = takeToken(nowUs);
+        if (!m_lastPassed) {
+            m_dropped++;
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            markPending(nowUs);
+            return false;
+        }
+
+        emitDropped(emit);
+        m_pendingSinceUs = -1;
+        m_passed.fetch_add(1, std::memory_order_relaxed);
+        emit(line);
+        return true;
+    }
+
+    // Reports counts that have waited NOTICE_INTERVAL_US, so a flood that
+    // never changes still shows up about once a second
+    template <typename Emit>
+    void flush(int64_t nowUs, Emit&& emit) {
+        if (m_pendingSinceUs < 0 || nowUs - m_pendingSinceUs < NOTICE_INTERVAL_US) return;
+        emitRepeats(emit);
+        emitDropped(emit);
+        m_pendingSinceUs = -1;
+    }
+
+    bool hasPending() const { return m_pendingSinceUs >= 0; }
+
+    uint64_t passed() const { return m_passed.load(std::memory_order_relaxed); }
+    uint64_t collapsed() const { return m_collapsed.load(std::memory_order_relaxed); }
+    uint64_t suppressed() const { return m_suppressed.load(std::memory_order_relaxed); }
+
+    static constexpr int64_t NOTICE_INTERVAL_US = 1000000;
+    static constexpr int BURST_SECONDS = 2;
+
+private:
+    void markPending(int64_t nowUs) {
+        if (m_pendingSinceUs < 0) m_pendingSinceUs = nowUs;
+    }
+
+    // Credit is kept in line-microseconds: a line costs 1e6, and each
+    // elapsed microsecond adds rate
+    bool takeToken(int64_t nowUs) {
+        int rate = m_rate.load(std::memory_order_relaxed);
+        if (rate <= 0) return true;
+
+        int64_t cap = (int64_t)rate * BURST_SECONDS * 1000000;
+        if (m_refillUs < 0) {
+            m_credit = cap;
+        } else if (nowUs > m_refillUs) {
+            m_credit += (nowUs - m_refillUs) * rate;
+            if (m_credit > cap) m_credit = cap;
+        }
+        m_refillUs = nowUs;
+
+        if (m_credit < 1000000) return false;
+        m_credit -= 1000000;
+        return true;
+    }
+
+    template <typename Emit>
+    void emitRepeats(Emit&& emit) {
+        if (m_repeats == 0) return;
+        char buf[64];
+        int len = snprintf(buf, sizeof(buf), "(previous line repeated %llu times)", (unsigned long long)m_repeats);
+        m_repeats = 0;
+        emit(std::string_view(buf, (size_t)len));
+    }
+
+    template <typename Emit>
+    void emitDropped(Emit&& emit) {
+        if (m_dropped == 0) return;
+        char buf[96];
+        int len = snprintf(buf, sizeof(buf), "(%llu %s lines suppressed, over gui_log_rate)",
+                           (unsigned long long)m_dropped, logOriginName(m_origin));
+        m_dropped = 0;
+        emit(std::string_view(buf, (size_t)len));
+    }
+
+    LogOrigin m_origin = LogOrigin::Command;
+    std::atomic<int> m_rate{0};
+
+    // Producer thread only
+    std::string m_last;  // Previous distinct line, buffer reused
+    bool m_haveLast = false;
+    bool m_lastPassed = false;
+    uint64_t m_repeats = 0;  // Collapsed since the last notice
+    uint64_t m_dropped = 0;  // Refused by the bucket since the last notice
+    int64_t m_pendingSinceUs = -1;
+    int64_t m_credit = 0;
+    int64_t m_refillUs = -1;
+
+    // Totals for gui_stats
+    std::atomic<uint64_t> m_passed{0};
+    std::atomic<uint64_t> m_collapsed{0};
+    std::atomic<uint64_t> m_suppressed{0};
+};
+
+#endif // LOG_LIMITER_HPP
@@ -0,0 +1,78 @@
+#ifndef LOG_LINE_HPP
+#define LOG_LINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string_view>
+
+// Where a log line entered the plugin
+enum class LogOrigin : uint8_t {
+    ServerPrint,  // pfnServerPrint from the game DLL or other plugins
+    GameEvent,    // pfnAlertMessage(at_logged)
+    Stdout,       // Captured process output
+    Stderr,
+    Command,      // Feedback from commands run through the GUI
+    COUNT
+};
+
+inline const char* logOriginName(LogOrigin origin) {
+    static const char* names[] = { "server_print", "game_event", "stdout", "stderr", "command" };
+    return names[(size_t)origin];
+}
+
+// Log timestamps: microseconds on CLOCK_MONOTONIC, shifted once so they
+// read as wall clock time. clock_gettime is a vDSO call (no syscall), so
+// every line can be stamped where it enters the plugin; the clock never
+// steps backwards when NTP adjusts the wall time.
+inline int64_t logClockUs() {
+    struct Clocks {
+        static int64_t read(clockid_t id) {
+            timespec ts;
+            clock_gettime(id, &ts);
+            return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+        }
+    };
+    static const int64_t wallOffset = Clocks::read(CLOCK_REALTIME) - Clocks::read(CLOCK_MONOTONIC);
+    return Clocks::read(CLOCK_MONOTONIC) + wallOffset;
+}
+
+// A line as it comes off a LineQueue: the text without its newline, viewed
+// in place, and the time it arrived. Formatting waits until display.
+struct LogLine {
+    int64_t time = 0;
+    std::string_view text;
+    LogOrigin origin = LogOrigin::Command;
+};
+
+// "HH:MM:SS.mmm" in local time. The broken-down time is cached per second,
+// so formatting a screenful of lines costs one localtime_r.
+class LogTimeFormat {
+public:
+    static constexpr size_t LENGTH = 12;
+
+    // Writes LENGTH characters (no terminator)
+    void format(int64_t timeUs, char* out) {
+        int64_t second = timeUs >= 0 ? timeUs / 1000000 : (timeUs - 999999) / 1000000;
+        if (second != m_second) {
+            time_t t = (time_t)second;
+            struct tm local;
+            localtime_r(&t, &local);
+            snprintf(m_hms, sizeof(m_hms), "%02d:%02d:%02d", local.tm_hour, local.tm_min, local.tm_sec);
+            m_second = second;
+        }
+        int millis = (int)((timeUs - second * 1000000) / 1000);
+        for (int i = 0; i < 8; i++) out[i] = m_hms[i];
+        out[8] = '.';
+        out[9] = (char)('0' + millis / 100);
+        out[10] = (char)('0' + millis / 10 % 10);
+        out[11] = (char)('0' + millis % 10);
+    }
+
+private:
+    int64_t m_second = INT64_MIN;
+    char m_hms[16] = {};
+};
+
+#endif // LOG_LINE_HPP
@@ -0,0 +1,357 @@
+#include "log_search.hpp"
+#include <algorithm>
+#include <cctype>
+
+static inline unsigned char lowerAscii(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Case-insensitive (ASCII) substring test; needle is already lowercase
+static bool containsLower(std::string_view haystack, std::string_view needle) {
+    if (needle.empty()) return true;
+    if (haystack.size() < needle.size()) return false;
+
+    size_t last = haystack.size() - needle.size();
+    for (size_t i = 0; i <= last; i++) {
+        size_t j = 0;
+        while (j < needle.size() && lowerAscii(haystack[i + j]) == (unsigned char)needle[j]) {
+            j++;
+        }
+        if (j == needle.size()) return true;
+    }
+    return false;
+}
+
+LogSearch::LogSearch()
+    : m_incomingFirstSeq(0)
+    , m_hasResults(false)
+    , m_stopping(false)
+    , m_openFirstSeq(0)
+    , m_activeValid(false)
+{
+}
+
+LogSearch::~LogSearch() {
+    stop();
+}
+
+bool LogSearch::start(std::function<void()> onResults) {
+    if (m_thread.joinable()) return true;
+
+    m_onResults = std::move(onResults);
+    m_stopping = false;
+    m_thread = std::thread(&LogSearch::searchMain, this);
+    return true;
+}
+
+void LogSearch::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void LogSearch::addLines(std::vector<std::string>& lines, std::vector<LogBlockPtr>& sealed, uint64_t firstSeq) {
+    if (lines.empty() && sealed.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_incoming.empty()) {
+            m_incoming.swap(lines);
+        } else {
+            m_incoming.insert(m_incoming.end(), std::make_move_iterator(lines.begin()),
+                              std::make_move_iterator(lines.end()));
+        }
+        m_incomingBlocks.insert(m_incomingBlocks.end(), sealed.begin(), sealed.end());
+        m_incomingFirstSeq = firstSeq;
+    }
+    lines.clear();
+    sealed.clear();
+    m_wake.notify_one();
+}
+
+void LogSearch::setQuery(const std::string& text, bool regex) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (text == m_query.text && regex == m_query.regex) return;
+        m_query.text = text;
+        m_query.regex = regex;
+        m_query.generation++;
+
+        // Anything not yet collected belongs to the old query
+        m_results = SearchResults();
+        m_hasResults = false;
+    }
+    m_wake.notify_one();
+}
+
+bool LogSearch::takeResults(SearchResults& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasResults) return false;
+    out = std::move(m_results);
+    m_results = SearchResults();
+    m_hasResults = false;
+    return true;
+}
+
+void LogSearch::publish(bool reset, bool error, std::vector<uint64_t>& seqs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_query.generation != m_active.generation) {
+            return;  // Superseded while we were searching
+        }
+        if (reset) {
+            m_results.reset = true;
+            m_results.seqs.clear();
+        }
+        m_results.error = error;
+        m_results.seqs.insert(m_results.seqs.end(), seqs.begin(), seqs.end());
+        m_hasResults = true;
+    }
+    if (m_onResults) {
+        m_onResults();
+    }
+}
+
+void LogSearch::searchMain() {
+    std::vector<std::string> batch;
+    std::vector<LogBlockPtr> blocks;
+    std::vector<uint64_t> found;
+
+    for (;;) {
+        Query query;
+        uint64_t firstSeq;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] {
+                return m_stopping || !m_incoming.empty() || !m_incomingBlocks.empty()
+                       || m_query.generation != m_active.generation;
+            });
+            if (m_stopping) break;
+            batch.swap(m_incoming);
+            blocks.swap(m_incomingBlocks);
+            firstSeq = m_incomingFirstSeq;
+            query = m_query;
+        }
+
+        // Same query: only the lines that just arrived need checking, while
+        // they are still plain text
+        found.clear();
+        bool sameQuery = query.generation == m_active.generation;
+        uint64_t seq = m_openFirstSeq + m_open.size();
+        for (std::string& line : batch) {
+            if (sameQuery && m_activeValid && matches(line)) {
+                found.push_back(seq);
+            }
+            m_open.push_back(std::move(line));
+            seq++;
+        }
+        batch.clear();
+
+        for (const LogBlockPtr& block : blocks) {
+            sealBlock(block);
+        }
+        blocks.clear();
+        retainFrom(firstSeq);
+
+        if (!sameQuery) {
+            // New query: answer it over everything retained
+            m_active = query;
+            bool ok = compile(query);
+            if (ok && m_activeValid) {
+                runFull(found);
+            }
+            publish(true, !ok, found);
+        } else if (!found.empty()) {
+            publish(false, false, found);
+        }
+    }
+}
+
+uint32_t LogSearch::filterBit(uint32_t trigram) {
+    return (trigram * 2654435761u) >> 16;  // Fibonacci hash down to 16 bits
+}
+
+// Builds the block's trigram filter from the text we still hold for it,
+// then lets the text go; from here on its lines come from the block
+void LogSearch::sealBlock(const LogBlockPtr& block) {
+    Block sealed;
+    sealed.data = block;
+    sealed.filter.assign(FILTER_BITS / 64, 0);
+
+    std::vector<uint32_t> trigrams;
+    auto addLine = [&](std::string_view line) {
+        trigramsOf(line, trigrams);
+        for (uint32_t key : trigrams) {
+            uint32_t bit = filterBit(key);
+            sealed.filter[bit / 64] |= 1ull << (bit % 64);
+        }
+    };
+
+    if (block->firstSeq == m_openFirstSeq && block->count <= m_open.size()) {
+        for (uint32_t i = 0; i < block->count; i++) {
+            addLine(m_open.front());
+            m_open.pop_front();
+        }
+    } else {
+        // Out of step (lines we never saw); read the block itself
+        for (uint64_t seq = block->firstSeq; seq < block->endSeq(); seq++) {
+            addLine(m_cache.line(*block, seq));
+        }
+        while (!m_open.empty() && m_openFirstSeq < block->endSeq()) {
+            m_open.pop_front();
+            m_openFirstSeq++;
+        }
+    }
+    m_openFirstSeq = std::max(m_openFirstSeq, block->endSeq());
+    m_blocks.push_back(std::move(sealed));
+}
+
+// Drops blocks the store has let go of
+void LogSearch::retainFrom(uint64_t firstSeq) {
+    while (!m_blocks.empty() && m_blocks.front().data->endSeq() <= firstSeq) {
+        m_blocks.pop_front();
+    }
+}
+
+// Unique lowercase trigrams, sorted
+void LogSearch::trigramsOf(std::string_view text, std::vector<uint32_t>& out) {
+    out.clear();
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        out.push_back((uint32_t)lowerAscii(text[i]) << 16
+                      | (uint32_t)lowerAscii(text[i + 1]) << 8
+                      | (uint32_t)lowerAscii(text[i + 2]));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// Longest run of plain characters every match of the pattern must contain.
+// Conservative: any alternation or group (a quantified group or a
+// lookaround may match without its contents) gives no literal at all; a
+// class or quantifier ends the run (and an optional quantifier also drops
+// the character it applies to).
+std::string LogSearch::requiredLiteral(const std::string& pattern) {
+    if (pattern.find('|') != std::string::npos) return std::string();
+
+    std::string best, run;
+    auto endRun = [&]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+
+    for (size_t i = 0; i < pattern.size(); i++) {
+        char c = pattern[i];
+        switch (c) {
+            case '\\':
+                if (i + 1 < pattern.size() && !isalnum((unsigned char)pattern[i + 1])) {
+                    run += (char)lowerAscii(pattern[++i]);  // Escaped punctuation is literal
+                } else {
+                    // A class, backreference or code escape; skip all of it
+                    endRun();
+                    char kind = ++i < pattern.size() ? pattern[i] : '\0';
+                    size_t length = kind == 'x' ? 2 : kind == 'u' ? 4 : kind == 'c' ? 1 : 0;
+                    i = std::min(i + length, pattern.size());
+                    while (isdigit((unsigned char)kind) && i + 1 < pattern.size()
+                           && isdigit((unsigned char)pattern[i + 1])) {
+                        i++;
+                    }
+                }
+                break;
+            case '?': case '*':
+                if (!run.empty()) run.pop_back();
+                endRun();
+                break;
+            case '{': {
+                if (!run.empty()) run.pop_back();
+                endRun();
+                size_t close = pattern.find('}', i + 1);
+                i = (close == std::string::npos) ? pattern.size() : close;
+                break;
+            }
+            case '[': {
+                endRun();
+                size_t close = pattern.find(']', i + 2);
+                i = (close == std::string::npos) ? pattern.size() : close;
+                break;
+            }
+            case '(': case ')':
+                return std::string();
+            case '.': case '^': case '$': case '+': case '}': case ']':
+                endRun();
+                break;
+            default:
+                run += (char)lowerAscii(c);
+                break;
+        }
+    }
+    endRun();
+    return best;
+}
+
+bool LogSearch::compile(const Query& query) {
+    m_activeValid = !query.text.empty();
+    m_trigrams.clear();
+    if (!m_activeValid) return true;
+
+    if (query.regex) {
+        try {
+            m_regex = std::regex(query.text, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+        } catch (const std::regex_error&) {
+            m_activeValid = false;
+            return false;
+        }
+        m_literal = requiredLiteral(query.text);
+    } else {
+        m_literal.clear();
+        for (char c : query.text) m_literal += (char)lowerAscii(c);
+    }
+
+    if (m_literal.size() >= 3) {
+        trigramsOf(m_literal, m_trigrams);
+    }
+    return true;
+}
+
+bool LogSearch::matches(std::string_view line) const {
+    if (!m_literal.empty() && !containsLower(line, m_literal)) {
+        return false;
+    }
+    if (m_active.regex) {
+        // libstdc++ runs regexes recursively, a frame or more per character;
+        // a whole 64 KiB line can overflow the thread's stack
+        if (line.size() > REGEX_MAX_BYTES) {
+            line = line.substr(0, REGEX_MAX_BYTES);
+        }
+        return std::regex_search(line.begin(), line.end(), m_regex);
+    }
+    return true;
+}
+
+bool LogSearch::mayMatch(const Block& block) const {
+    for (uint32_t key : m_trigrams) {
+        uint32_t bit = filterBit(key);
+        if (!(block.filter[bit / 64] & (1ull << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+void LogSearch::runFull(std::vector<uint64_t>& out) {
+    // Blocks missing any of the query's trigrams are never decompressed.
+    // With nothing to narrow by (short or unanchored pattern) every
+    // block is scanned.
+    for (const Block& block : m_blocks) {
+        if (!mayMatch(block)) continue;
+        for (uint64_t seq = block.data->firstSeq; seq < block.data->endSeq(); seq++) {
+            if (matches(m_cache.line(*block.data, seq))) out.push_back(seq);
+        }
+    }
+
+    uint64_t seq = m_openFirstSeq;
+    for (const std::string& line : m_open) {
+        if (matches(line)) out.push_back(seq);
+        seq++;
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef LOG_SEARCH_HPP
+#define LOG_SEARCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log_store.hpp"
+
+// Matches handed back to the GUI. When reset is set the previous list is
+// stale (new query) and seqs is the full result; otherwise seqs are new
+// matches among lines added since the last batch.
+struct SearchResults {
+    bool reset = false;
+    bool error = false;  // Query did not compile (bad regex)
+    std::vector<uint64_t> seqs;
+};
+
+// The lines of another source that are listed in a match list, in order.
+// Has its own sequence numbers so the view can scroll it like any source.
+class FilteredLogSource : public LogSource {
+public:
+    explicit FilteredLogSource(const LogSource& base) : m_base(base), m_dropped(0) {}
+
+    void reset(const std::vector<uint64_t>& seqs) {
+        m_matches.assign(seqs.begin(), seqs.end());
+        m_dropped = 0;
+        prune();
+    }
+    void append(const std::vector<uint64_t>& seqs) {
+        m_matches.insert(m_matches.end(), seqs.begin(), seqs.end());
+        prune();
+    }
+
+    // Drops matches whose lines the base source has evicted
+    void prune() {
+        while (!m_matches.empty() && m_matches.front() < m_base.firstSeq()) {
+            m_matches.pop_front();
+            m_dropped++;
+        }
+    }
+
+    uint64_t firstSeq() const override { return m_dropped; }
+    uint64_t endSeq() const override { return m_dropped + m_matches.size(); }
+    std::string_view line(uint64_t seq) const override { return m_base.line(m_matches[(size_t)(seq - m_dropped)]); }
+
+    bool hasTimes() const override { return m_base.hasTimes(); }
+    int64_t timeOf(uint64_t seq) const override { return m_base.timeOf(m_matches[(size_t)(seq - m_dropped)]); }
+
+    // First match at or after the base source's line for that time
+    uint64_t seqForTime(int64_t time) const override {
+        auto it = std::lower_bound(m_matches.begin(), m_matches.end(), m_base.seqForTime(time));
+        return m_dropped + (uint64_t)(it - m_matches.begin());
+    }
+
+private:
+    const LogSource& m_base;
+    std::deque<uint64_t> m_matches;
+    uint64_t m_dropped;
+};
+
+// Live filter over the log scrollback. The GUI hands over every line it
+// stores, in order, plus each block its LogStore seals, so sequence
+// numbers agree. A background thread keeps a 64 Kbit trigram filter per
+// sealed block: a query only decompresses and scans the blocks whose
+// filter holds all of its trigrams. Lines not sealed yet are kept as text
+// and scanned directly, and new lines keep being checked against the
+// current query.
+class LogSearch {
+public:
+    LogSearch();
+    ~LogSearch();
+    LogSearch(const LogSearch&) = delete;
+    LogSearch& operator=(const LogSearch&) = delete;
+
+    // onResults runs on the search thread whenever results are ready
+    bool start(std::function<void()> onResults);
+    void stop();
+
+    // GUI thread. Takes the contents of lines and sealed; firstSeq is the
+    // store's oldest retained line.
+    void addLines(std::vector<std::string>& lines, std::vector<LogBlockPtr>& sealed, uint64_t firstSeq);
+    void setQuery(const std::string& text, bool regex);  // Empty text clears
+    bool takeResults(SearchResults& out);
+
+private:
+    struct Block {
+        LogBlockPtr data;
+        std::vector<uint64_t> filter;  // FILTER_BITS, bit per hashed trigram
+    };
+
+    struct Query {
+        std::string text;
+        bool regex = false;
+        uint64_t generation = 0;
+    };
+
+    void searchMain();
+    void sealBlock(const LogBlockPtr& block);
+    void retainFrom(uint64_t firstSeq);
+    bool compile(const Query& query);
+    bool matches(std::string_view line) const;
+    bool mayMatch(const Block& block) const;
+    void runFull(std::vector<uint64_t>& out);
+    void publish(bool reset, bool error, std::vector<uint64_t>& seqs);
+
+    static uint32_t filterBit(uint32_t trigram);
+    static void trigramsOf(std::string_view text, std::vector<uint32_t>& out);
+    static std::string requiredLiteral(const std::string& pattern);
+
+    std::thread m_thread;
+    std::function<void()> m_onResults;
+
+    // Shared with the GUI thread
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::string> m_incoming;
+    std::vector<LogBlockPtr> m_incomingBlocks;
+    uint64_t m_incomingFirstSeq;
+    Query m_query;
+    SearchResults m_results;
+    bool m_hasResults;
+    bool m_stopping;
+
+    // Search thread only
+    std::deque<Block> m_blocks;       // Sealed, oldest first
+    std::deque<std::string> m_open;   // Lines after the last sealed block
+    uint64_t m_openFirstSeq;
+    LogBlockCache m_cache;
+    Query m_active;
+    bool m_activeValid;
+    std::regex m_regex;
+    std::string m_literal;              // Lowercased, required in every match
+    std::vector<uint32_t> m_trigrams;   // Of m_literal
+
+    static constexpr uint32_t FILTER_BITS = 1 << 16;
+    static constexpr size_t REGEX_MAX_BYTES = 4096;  // Of each line, for a regex filter
+};
+
+#endif // LOG_SEARCH_HPP
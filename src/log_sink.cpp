@@ -0,0 +1,637 @@
+#include "log_sink.hpp"
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+// Writes value as exactly `digits` decimal digits
+static void appendDigits(std::string& out, int64_t value, int digits) {
+    char buf[20];
+    for (int i = digits - 1; i >= 0; i--) {
+        buf[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    out.append(buf, digits);
+}
+
+// Length of the valid UTF-8 sequence at p, or 0 if it is not one
+static size_t utf8Length(const unsigned char* p, const unsigned char* end) {
+    size_t length = *p < 0xC2 ? 0 : *p < 0xE0 ? 2 : *p < 0xF0 ? 3 : *p < 0xF5 ? 4 : 0;
+    if (length == 0 || (size_t)(end - p) < length) return 0;
+    for (size_t i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    }
+    return length;
+}
+
+// Player names are arbitrary bytes; anything that is not valid UTF-8 is
+// replaced so every record stays valid JSON
+static void appendJsonString(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    out += '"';
+    while (p < end) {
+        unsigned char c = *p;
+        if (c >= 0x80) {
+            size_t length = utf8Length(p, end);
+            if (length == 0) {
+                out += "\\ufffd";
+                p++;
+            } else {
+                out.append(reinterpret_cast<const char*>(p), length);
+                p += length;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 15];
+                } else {
+                    out += (char)c;
+                }
+        }
+        p++;
+    }
+    out += '"';
+}
+
+void LogFormatter::stamp(int64_t timeUs) {
+    int64_t second = timeUs >= 0 ? timeUs / 1000000 : (timeUs - 999999) / 1000000;
+    if (second == m_second) return;
+    m_second = second;
+
+    time_t t = (time_t)second;
+    struct tm parts;
+    if (m_format == LogFormat::Syslog) {
+        localtime_r(&t, &parts);
+        m_dateLength = strftime(m_date, sizeof(m_date), "%b %e %H:%M:%S", &parts);
+    } else {
+        gmtime_r(&t, &parts);
+        m_dateLength = strftime(m_date, sizeof(m_date), "%Y-%m-%dT%H:%M:%S", &parts);
+    }
+}
+
+void LogFormatter::format(const LogLine& line, std::string& out) {
+    stamp(line.time);
+    int64_t micros = line.time - m_second * 1000000;
+
+    switch (m_format) {
+        case LogFormat::Plain:
+            out.append(m_date, m_dateLength);
+            out += '.';
+            appendDigits(out, micros, 6);
+            out += "Z ";
+            out += logOriginName(line.origin);
+            out += ": ";
+            out.append(line.text.data(), line.text.size());
+            out += '\n';
+            break;
+
+        case LogFormat::Json:
+            out += "{\"time\":\"";
+            out.append(m_date, m_dateLength);
+            out += '.';
+            appendDigits(out, micros, 6);
+            out += "Z\",\"source\":\"";
+            out += logOriginName(line.origin);
+            out += "\",\"text\":";
+            appendJsonString(out, line.text);
+            out += "}\n";
+            break;
+
+        case LogFormat::Syslog: {
+            // Facility user; stderr is a warning, the rest informational
+            int priority = 8 + (line.origin == LogOrigin::Stderr ? 4 : 6);
+            out += '<';
+            out += std::to_string(priority);
+            out += '>';
+            out.append(m_date, m_dateLength);
+            out += " metamod-gui: ";
+            out.append(line.text.data(), line.text.size());
+            break;
+        }
+    }
+}
+
+static const char* formatName(LogFormat format) {
+    switch (format) {
+        case LogFormat::Json: return "json";
+        case LogFormat::Syslog: return "syslog";
+        default: return "plain";
+    }
+}
+
+FileSink::FileSink(const std::string& path, LogFormat format, uint64_t maxBytes, int keep)
+    : m_path(path)
+    , m_formatter(format)
+    , m_format(format)
+    , m_maxBytes(maxBytes)
+    , m_keep(std::max(keep, 1))
+    , m_fd(-1)
+    , m_fifo(false)
+    , m_size(0)
+    , m_retryAt(0)
+{
+    m_buffer.reserve(BUFFER_BYTES * 2);
+}
+
+FileSink::~FileSink() {
+    flush();
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+// Opened lazily and again after errors, at most once a second
+bool FileSink::reopen(int64_t now) {
+    if (m_fd != -1) return true;
+    if (now < m_retryAt) return false;
+
+    // O_NONBLOCK only matters for a FIFO: open fails at once without a reader
+    m_fd = open(m_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_NONBLOCK | O_CLOEXEC, 0644);
+    struct stat st;
+    if (m_fd == -1 || fstat(m_fd, &st) == -1) {
+        if (m_fd != -1) close(m_fd);
+        m_fd = -1;
+        m_retryAt = now + 1000000;
+        return false;
+    }
+    m_fifo = S_ISFIFO(st.st_mode);
+    m_size = (uint64_t)st.st_size;
+    return true;
+}
+
+// path.N-1 -> path.N, ..., path -> path.1; the oldest falls off the end
+void FileSink::rotate() {
+    close(m_fd);
+    m_fd = -1;
+    for (int i = m_keep - 1; i >= 1; i--) {
+        std::string from = m_path + "." + std::to_string(i);
+        std::string to = m_path + "." + std::to_string(i + 1);
+        rename(from.c_str(), to.c_str());
+    }
+    rename(m_path.c_str(), (m_path + ".1").c_str());
+    m_size = 0;
+    m_retryAt = 0;
+}
+
+LogSink::Result FileSink::write(const LogLine& line) {
+    if (!reopen(line.time)) {
+        return Result::Dropped;
+    }
+    if (m_buffer.size() >= BUFFER_BYTES) {
+        flush();
+        if (m_buffer.size() >= BUFFER_BYTES) {
+            return Result::Retry;  // FIFO reader is behind
+        }
+    }
+    m_formatter.format(line, m_buffer);
+    return Result::Written;
+}
+
+void FileSink::flush() {
+    size_t done = 0;
+    while (m_fd != -1 && done < m_buffer.size()) {
+        ssize_t n = ::write(m_fd, m_buffer.data() + done, m_buffer.size() - done);
+        if (n > 0) {
+            done += (size_t)n;
+            m_size += (uint64_t)n;
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            // Disk full, FIFO reader gone, ...: what is left is lost
+            close(m_fd);
+            m_fd = -1;
+            m_retryAt = 0;
+            done = m_buffer.size();
+        }
+    }
+    m_buffer.erase(0, done);
+
+    // Only between whole lines, so no line is split across files
+    if (m_fd != -1 && !m_fifo && m_maxBytes > 0 && m_size >= m_maxBytes && m_buffer.empty()) {
+        rotate();
+    }
+}
+
+std::string FileSink::describe() const {
+    return std::string(m_format == LogFormat::Json ? "json " : "file ") + m_path
+           + (m_fifo ? " (fifo)" : "");
+}
+
+DatagramSink::DatagramSink(const std::string& path, LogFormat format)
+    : m_path(path)
+    , m_formatter(format)
+    , m_format(format)
+    , m_fd(socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0))
+{
+}
+
+DatagramSink::~DatagramSink() {
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+LogSink::Result DatagramSink::write(const LogLine& line) {
+    if (m_fd == -1) return Result::Dropped;
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, m_path.data(), std::min(m_path.size(), sizeof(addr.sun_path) - 1));
+
+    m_buffer.clear();
+    m_formatter.format(line, m_buffer);
+    for (;;) {
+        ssize_t n = sendto(m_fd, m_buffer.data(), m_buffer.size(), MSG_NOSIGNAL,
+                           reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        if (n >= 0) return Result::Written;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) return Result::Retry;
+        return Result::Dropped;  // No listener, or the line is too big for it
+    }
+}
+
+std::string DatagramSink::describe() const {
+    return std::string(m_format == LogFormat::Syslog ? "syslog " : "socket ") + m_path
+           + " (" + formatName(m_format) + ")";
+}
+
+LogSinkWriter::Ring::Ring(size_t capacity)
+    : m_capacity(capacity)
+    , m_firstSeq(0)
+    , m_head(0)
+    , m_tail(0)
+{
+}
+
+// Records are a header and the text, 16-byte aligned and never split by the
+// end of the buffer; the oldest lines are overwritten to make room
+void LogSinkWriter::Ring::push(const LogLine& line) {
+    struct Header {
+        uint32_t length;
+        uint32_t origin;
+        int64_t time;
+    };
+    if (m_data.empty()) {
+        m_data.resize(m_capacity);
+    }
+    size_t capacity = m_capacity;
+    size_t need = (sizeof(Header) + line.text.size() + 15) & ~(size_t)15;
+    size_t offset = (size_t)(m_tail & (capacity - 1));
+    size_t skip = capacity - offset < need ? capacity - offset : 0;
+
+    while (m_tail + skip + need - m_head > capacity) {
+        m_positions.pop_front();
+        m_firstSeq++;
+        m_head = m_positions.empty() ? m_tail : m_positions.front();
+    }
+
+    uint64_t position = m_tail + skip;
+    Header header = { (uint32_t)line.text.size(), (uint32_t)line.origin, line.time };
+    char* record = m_data.data() + (position & (capacity - 1));
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), line.text.data(), line.text.size());
+
+    m_positions.push_back(position);
+    m_tail = position + need;
+}
+
+LogLine LogSinkWriter::Ring::at(uint64_t seq) const {
+    struct Header {
+        uint32_t length;
+        uint32_t origin;
+        int64_t time;
+    };
+    const char* record = m_data.data() + (m_positions[(size_t)(seq - m_firstSeq)] & (m_data.size() - 1));
+    Header header;
+    memcpy(&header, record, sizeof(header));
+    return LogLine{ header.time, std::string_view(record + sizeof(header), header.length), (LogOrigin)header.origin };
+}
+
+LogSinkWriter::LogSinkWriter()
+    : m_active(false)
+    , m_stopping(false)
+    , m_ring(RING_BYTES)
+{
+    for (auto& dropped : m_queueDropped) {
+        dropped = 0;
+    }
+}
+
+LogSinkWriter::~LogSinkWriter() {
+    stop();
+}
+
+void LogSinkWriter::add(std::unique_ptr<LogSink> sink) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_incoming.push_back(std::move(sink));
+    }
+    m_active.store(true, std::memory_order_relaxed);
+    if (!m_thread.joinable()) {
+        m_stopping = false;
+        m_thread = std::thread(&LogSinkWriter::writerMain, this);
+    }
+}
+
+// Sinks go once the writer has handed them what was already queued
+void LogSinkWriter::clear() {
+    m_active.store(false, std::memory_order_relaxed);
+    stop();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots.clear();
+    m_incoming.clear();
+}
+
+void LogSinkWriter::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void LogSinkWriter::submit(Producer producer, std::string_view text, int64_t time, LogOrigin origin) {
+    if (!m_queues[producer].push(text, time, origin)) {
+        // Writer is behind; never hold up the producer
+        m_queueDropped[producer].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<std::string> LogSinkWriter::describe() {
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& slot : m_slots) {
+        char counts[160];
+        snprintf(counts, sizeof(counts), ": %llu written, %llu dropped, %llu pending (drop %s, backlog %zu)",
+                 (unsigned long long)slot->written.load(std::memory_order_relaxed),
+                 (unsigned long long)slot->dropped.load(std::memory_order_relaxed),
+                 (unsigned long long)slot->pending.load(std::memory_order_relaxed),
+                 slot->sink->policy == DropPolicy::Newest ? "newest" : "oldest", slot->sink->backlog);
+        lines.push_back(slot->sink->describe() + counts);
+    }
+    for (const auto& sink : m_incoming) {
+        lines.push_back(sink->describe() + ": starting");
+    }
+    return lines;
+}
+
+void LogSinkWriter::writerMain() {
+    // A FIFO whose reader went away must fail with EPIPE, not kill the server
+    sigset_t pipe;
+    sigemptyset(&pipe);
+    sigaddset(&pipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS), [this] { return m_stopping; });
+            stopping = m_stopping;
+
+            // New sinks start at the live end
+            for (auto& sink : m_incoming) {
+                auto slot = std::make_unique<Slot>();
+                slot->sink = std::move(sink);
+                slot->cursor = m_ring.endSeq();
+                m_slots.push_back(std::move(slot));
+            }
+            m_incoming.clear();
+        }
+
+        // Producers don't signal; a short poll batches lines for free
+        ingest();
+        for (auto& slot : m_slots) {
+            deliver(*slot);
+            slot->sink->flush();
+        }
+        if (stopping) break;
+    }
+}
+
+// Both producer queues into the ring, oldest first, so lines from the game
+// and from captured output interleave as they happened
+void LogSinkWriter::ingest() {
+    for (int producer = 0; producer < NUM_PRODUCERS; producer++) {
+        unsigned dropped = m_queueDropped[producer].exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            char notice[64];
+            int len = snprintf(notice, sizeof(notice), "(%u log lines dropped before the sinks)", dropped);
+            m_ring.push(LogLine{ logClockUs(), std::string_view(notice, (size_t)len), LogOrigin::Command });
+        }
+    }
+
+    LogLine heads[NUM_PRODUCERS];
+    bool have[NUM_PRODUCERS];
+    for (int producer = 0; producer < NUM_PRODUCERS; producer++) {
+        have[producer] = m_queues[producer].front(heads[producer]);
+    }
+
+    for (;;) {
+        int next = -1;
+        for (int producer = 0; producer < NUM_PRODUCERS; producer++) {
+            if (have[producer] && (next < 0 || heads[producer].time < heads[next].time)) {
+                next = producer;
+            }
+        }
+        if (next < 0) break;
+
+        uint64_t seq = m_ring.endSeq();
+        m_ring.push(heads[next]);
+        m_queues[next].pop();
+        have[next] = m_queues[next].front(heads[next]);
+
+        // Sinks that drop the newest lines refuse this one if they are full
+        for (auto& slot : m_slots) {
+            if (slot->sink->policy != DropPolicy::Newest || seq - slot->cursor < slot->sink->backlog) continue;
+            if (!slot->gaps.empty() && slot->gaps.back().second == seq) {
+                slot->gaps.back().second++;
+            } else {
+                slot->gaps.emplace_back(seq, seq + 1);
+            }
+            slot->unreported++;
+            slot->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Moves the cursor past a skipped range that starts at it
+bool LogSinkWriter::skipGap(Slot& slot) {
+    while (!slot.gaps.empty() && slot.gaps.front().second <= slot.cursor) {
+        slot.gaps.pop_front();
+    }
+    if (slot.gaps.empty() || slot.gaps.front().first > slot.cursor) return false;
+    slot.cursor = slot.gaps.front().second;
+    slot.gaps.pop_front();
+    return true;
+}
+
+void LogSinkWriter::writeNotice(Slot& slot) {
+    char notice[64];
+    int len = snprintf(notice, sizeof(notice), "(%llu log lines dropped by this sink)",
+                       (unsigned long long)slot.unreported);
+    if (slot.sink->write(LogLine{ logClockUs(), std::string_view(notice, (size_t)len), LogOrigin::Command })
+        != LogSink::Result::Retry) {
+        slot.unreported = 0;
+    }
+}
+
+void LogSinkWriter::deliver(Slot& slot) {
+    uint64_t end = m_ring.endSeq();
+
+    // Overwritten in the ring before this sink got to them
+    if (slot.cursor < m_ring.firstSeq()) {
+        uint64_t lost = m_ring.firstSeq() - slot.cursor;
+        slot.unreported += lost;
+        slot.dropped.fetch_add(lost, std::memory_order_relaxed);
+        slot.cursor = m_ring.firstSeq();
+    }
+    if (slot.sink->policy == DropPolicy::Oldest && end - slot.cursor > slot.sink->backlog) {
+        uint64_t skipped = end - slot.sink->backlog - slot.cursor;
+        slot.unreported += skipped;
+        slot.dropped.fetch_add(skipped, std::memory_order_relaxed);
+        slot.cursor += skipped;
+    }
+
+    if (slot.unreported > 0) {
+        writeNotice(slot);
+    }
+
+    while (slot.cursor < end) {
+        if (skipGap(slot)) continue;
+
+        LogSink::Result result = slot.sink->write(m_ring.at(slot.cursor));
+        if (result == LogSink::Result::Retry) break;
+        if (result == LogSink::Result::Written) {
+            slot.written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            slot.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot.cursor++;
+    }
+    slot.pending.store(end - std::min(slot.cursor, end), std::memory_order_relaxed);
+}
+
+static bool parseCount(const std::string& text, uint64_t& out) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos || text.size() > 12) {
+        return false;
+    }
+    out = std::stoull(text);
+    return true;
+}
+
+// Relative, and no component steps out of the directory it is taken from
+static bool isConfinedPath(const std::string& path) {
+    if (path[0] == '/') return false;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (path.compare(start, end - start, "..") == 0) return false;
+        start = end + 1;
+    }
+    return true;
+}
+
+std::unique_ptr<LogSink> makeLogSink(const std::vector<std::string>& args, const std::string& baseDir,
+                                     const std::string& logDir, bool anyPath, std::string& error) {
+    if (args.empty()) {
+        error = "missing sink type";
+        return nullptr;
+    }
+    const std::string& type = args[0];
+    bool isFile = type == "file" || type == "json";
+    if (!isFile && type != "socket" && type != "syslog") {
+        error = "unknown sink type '" + type + "'";
+        return nullptr;
+    }
+
+    size_t next = 1;
+    std::string target = type == "syslog" ? "/dev/log" : "";
+    if (next < args.size() && args[next].find('=') == std::string::npos) {
+        target = args[next++];
+    }
+    if (target.empty()) {
+        error = type + " needs a path";
+        return nullptr;
+    }
+    // A file sink appends text players control, so by default it may only
+    // write under logDir, whoever runs the command
+    if (isFile && !anyPath && !isConfinedPath(target)) {
+        error = type + " path must be relative to " + logDir + " and not contain '..'";
+        return nullptr;
+    }
+    if (target[0] != '/') {
+        if (isFile && mkdir(logDir.c_str(), 0755) == -1 && errno != EEXIST) {
+            error = "cannot create " + logDir + ": " + strerror(errno);
+            return nullptr;
+        }
+        target = (isFile ? logDir : baseDir) + "/" + target;
+    }
+    if (!isFile && target.size() >= sizeof(sockaddr_un::sun_path)) {
+        error = "socket path too long";
+        return nullptr;
+    }
+
+    uint64_t maxMb = 64, keep = 5, backlog = 65536;
+    DropPolicy policy = DropPolicy::Oldest;
+    LogFormat format = type == "json" ? LogFormat::Json : type == "syslog" ? LogFormat::Syslog : LogFormat::Plain;
+    for (; next < args.size(); next++) {
+        const std::string& option = args[next];
+        size_t eq = option.find('=');
+        std::string key = option.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : option.substr(eq + 1);
+
+        bool ok = true;
+        if (key == "max_mb" && isFile) {
+            ok = parseCount(value, maxMb);
+        } else if (key == "keep" && isFile) {
+            ok = parseCount(value, keep) && keep >= 1 && keep <= 100;
+        } else if (key == "backlog") {
+            ok = parseCount(value, backlog) && backlog >= 1;
+        } else if (key == "drop") {
+            ok = value == "oldest" || value == "newest";
+            policy = value == "newest" ? DropPolicy::Newest : DropPolicy::Oldest;
+        } else if (key == "format" && type == "socket") {
+            ok = value == "plain" || value == "json";
+            format = value == "json" ? LogFormat::Json : LogFormat::Plain;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "bad option '" + option + "' for " + type;
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<LogSink> sink;
+    if (isFile) {
+        sink = std::make_unique<FileSink>(target, format, maxMb * 1024 * 1024, (int)keep);
+    } else {
+        sink = std::make_unique<DatagramSink>(target, format);
+    }
+    sink->policy = policy;
+    sink->backlog = (size_t)backlog;
+    return sink;
+}
@@ -0,0 +1,206 @@
+#ifndef LOG_SINK_HPP
+#define LOG_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "line_queue.hpp"
+#include "log_line.hpp"
+
+enum class LogFormat : uint8_t {
+    Plain,   // "2026-10-17T01:14:21.474123Z server_print: text"
+    Json,    // {"time":"...","source":"server_print","text":"..."}
+    Syslog   // RFC 3164, for /dev/log
+};
+
+// Turns lines into bytes for a sink, appending to a buffer the sink reuses.
+// The date part of the timestamp is formatted once per second.
+class LogFormatter {
+public:
+    explicit LogFormatter(LogFormat format) : m_format(format) {}
+
+    // Appends the formatted line, newline included except for Syslog
+    void format(const LogLine& line, std::string& out);
+
+private:
+    void stamp(int64_t timeUs);
+
+    LogFormat m_format;
+    int64_t m_second = INT64_MIN;
+    char m_date[64] = {};
+    size_t m_dateLength = 0;
+};
+
+// What a sink does when it falls more than its backlog behind
+enum class DropPolicy : uint8_t {
+    Oldest,  // Skip its oldest unsent lines and carry on with recent ones
+    Newest   // Keep its place; lines arriving meanwhile are skipped
+};
+
+// An output for log lines, driven only by the LogSinkWriter thread. write()
+// must not block: a sink that cannot take a line right now says Retry and
+// gets it again later.
+class LogSink {
+public:
+    enum class Result { Written, Retry, Dropped };
+
+    virtual ~LogSink() = default;
+    virtual Result write(const LogLine& line) = 0;
+    virtual void flush() {}
+    virtual std::string describe() const = 0;
+
+    DropPolicy policy = DropPolicy::Oldest;
+    size_t backlog = 65536;  // Lines
+};
+
+// Appends to a file, rotated to path.1 .. path.keep once it passes
+// maxBytes. A FIFO is written non-blocking and never rotated; with no
+// reader attached its lines are dropped.
+class FileSink : public LogSink {
+public:
+    FileSink(const std::string& path, LogFormat format, uint64_t maxBytes, int keep);
+    ~FileSink() override;
+
+    Result write(const LogLine& line) override;
+    void flush() override;
+    std::string describe() const override;
+
+private:
+    bool reopen(int64_t now);
+    void rotate();
+
+    std::string m_path;
+    LogFormatter m_formatter;
+    LogFormat m_format;
+    uint64_t m_maxBytes;
+    int m_keep;
+    int m_fd;
+    bool m_fifo;
+    uint64_t m_size;
+    int64_t m_retryAt;  // Next open attempt after a failure
+    std::string m_buffer;  // Formatted, not yet written
+
+    static constexpr size_t BUFFER_BYTES = 64 * 1024;
+};
+
+// Sends each line as one datagram to a Unix socket: a log shipper's
+// listener, or /dev/log in syslog format. Lines are dropped while nothing
+// listens, and retried while the receiver's buffer is full.
+class DatagramSink : public LogSink {
+public:
+    DatagramSink(const std::string& path, LogFormat format);
+    ~DatagramSink() override;
+
+    Result write(const LogLine& line) override;
+    std::string describe() const override;
+
+private:
+    std::string m_path;
+    LogFormatter m_formatter;
+    LogFormat m_format;
+    int m_fd;
+    std::string m_buffer;
+};
+
+// Builds a sink from gui_log_sink arguments: a type (file, json, socket,
+// syslog), its target and key=value options. File and json paths are taken
+// from logDir and may not leave it (no absolute path, no ".." component)
+// unless anyPath is set; other relative paths are taken from baseDir.
+// Returns null with error set when the arguments don't make sense.
+std::unique_ptr<LogSink> makeLogSink(const std::vector<std::string>& args, const std::string& baseDir,
+                                     const std::string& logDir, bool anyPath, std::string& error);
+
+// Fans lines out to any number of sinks on a writer thread. Producers copy
+// each line once into their own LineQueue and never wait on a sink. The
+// writer moves lines into a shared ring that every sink reads with its own
+// cursor, so a stuck sink only falls behind (and drops lines under its
+// DropPolicy) while the others keep up.
+class LogSinkWriter {
+public:
+    // A producer thread; each has its own queue
+    enum Producer { GAME, CAPTURE, NUM_PRODUCERS };
+
+    LogSinkWriter();
+    ~LogSinkWriter();
+    LogSinkWriter(const LogSinkWriter&) = delete;
+    LogSinkWriter& operator=(const LogSinkWriter&) = delete;
+
+    // Game thread. The writer thread runs while there are sinks.
+    void add(std::unique_ptr<LogSink> sink);
+    void clear();
+    void stop();
+
+    // Any thread; producers check this before doing anything
+    bool active() const { return m_active.load(std::memory_order_relaxed); }
+
+    // From the producer's own thread only
+    void submit(Producer producer, std::string_view text, int64_t time, LogOrigin origin);
+
+    // One line per sink with its counters
+    std::vector<std::string> describe();
+
+    static constexpr size_t MAX_LINE_BYTES = 64 * 1024;
+
+private:
+    struct Slot {
+        std::unique_ptr<LogSink> sink;
+        uint64_t cursor = 0;
+        std::deque<std::pair<uint64_t, uint64_t>> gaps;  // Skipped [from, to), DropPolicy::Newest
+        uint64_t unreported = 0;  // Dropped since the last notice
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> pending{0};
+    };
+
+    // Lines in arrival order, addressed by sequence number; writer thread only
+    class Ring {
+    public:
+        explicit Ring(size_t capacity);
+        void push(const LogLine& line);
+        LogLine at(uint64_t seq) const;
+        uint64_t firstSeq() const { return m_firstSeq; }
+        uint64_t endSeq() const { return m_firstSeq + m_positions.size(); }
+
+    private:
+        std::vector<char> m_data;  // Allocated by the first push
+        size_t m_capacity;
+        std::deque<uint64_t> m_positions;  // Byte position of each line
+        uint64_t m_firstSeq;
+        uint64_t m_head;  // Byte positions; only grow
+        uint64_t m_tail;
+    };
+
+    void writerMain();
+    void ingest();
+    void deliver(Slot& slot);
+    bool skipGap(Slot& slot);
+    void writeNotice(Slot& slot);
+
+    LineQueue<1 << 20, MAX_LINE_BYTES> m_queues[NUM_PRODUCERS];
+    std::atomic<unsigned> m_queueDropped[NUM_PRODUCERS];
+    std::atomic<bool> m_active;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::unique_ptr<LogSink>> m_incoming;  // Guarded by m_mutex
+    bool m_stopping;
+
+    std::vector<std::unique_ptr<Slot>> m_slots;  // Changed by the writer under m_mutex
+    Ring m_ring;  // Writer thread
+
+    static constexpr size_t RING_BYTES = 8 * 1024 * 1024;
+    static constexpr int WRITE_INTERVAL_MS = 20;
+};
+
+#endif // LOG_SINK_HPP
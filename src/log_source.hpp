@@ -0,0 +1,29 @@
+#ifndef LOG_SOURCE_HPP
+#define LOG_SOURCE_HPP
+
+#include <cstdint>
+#include <string_view>
+
+// Read side of a log store, addressed by line sequence numbers that keep
+// counting across eviction. Views into the store stay valid until the
+// next call that modifies it; sources that decompress or map on demand
+// also recycle them after reading from a few other blocks.
+class LogSource {
+public:
+    virtual ~LogSource() = default;
+
+    // Retained lines are [firstSeq(), endSeq())
+    virtual uint64_t firstSeq() const = 0;
+    virtual uint64_t endSeq() const = 0;
+    virtual std::string_view line(uint64_t seq) const = 0;
+
+    // Sources that record wall clock times can seek by them
+    virtual bool hasTimes() const { return false; }
+    virtual int64_t timeOf(uint64_t /*seq*/) const { return 0; }
+    virtual uint64_t seqForTime(int64_t /*time*/) const { return firstSeq(); }
+
+    bool empty() const { return firstSeq() == endSeq(); }
+    uint64_t lineCount() const { return endSeq() - firstSeq(); }
+};
+
+#endif // LOG_SOURCE_HPP
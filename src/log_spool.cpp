@@ -0,0 +1,373 @@
+#include "log_spool.hpp"
+#include "log_line.hpp"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+LogSpool::LogSpool()
+    : m_open(false)
+    , m_useClock(0)
+{
+}
+
+LogSpool::~LogSpool() {
+    close();
+}
+
+// Segment files are named after their first sequence number, zero padded
+// so that name order is seq order
+static std::string segmentName(uint64_t firstSeq) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".seg", firstSeq);
+    return name;
+}
+
+bool LogSpool::open(const std::string& dir) {
+    if (m_open) return true;
+
+    if (mkdir(dir.c_str(), 0755) == -1 && errno != EEXIST) {
+        return false;
+    }
+    m_dir = dir;
+
+    std::vector<Segment> found;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (struct dirent* entry = readdir(d)) {
+            size_t len = strlen(entry->d_name);
+            if (len <= 4 || strcmp(entry->d_name + len - 4, ".seg") != 0) continue;
+
+            Segment segment;
+            if (loadSegment(dir + "/" + entry->d_name, segment)) {
+                found.push_back(std::move(segment));
+            }
+        }
+        closedir(d);
+    }
+
+    std::sort(found.begin(), found.end(), [](const Segment& a, const Segment& b) {
+        return a.firstSeq < b.firstSeq;
+    });
+
+    // Sequence numbers must be contiguous; keep only the run after any gap
+    size_t runStart = 0;
+    for (size_t i = 1; i < found.size(); i++) {
+        if (found[i - 1].firstSeq + found[i - 1].count != found[i].firstSeq) {
+            runStart = i;
+        }
+    }
+    m_segments.assign(std::make_move_iterator(found.begin() + runStart),
+                      std::make_move_iterator(found.end()));
+
+    enforceRetention(logClockUs());
+
+    if (!m_segments.empty() && resumeSegment(m_segments.back())) {
+        return true;
+    }
+
+    uint64_t nextSeq = m_segments.empty() ? 0 : m_segments.back().firstSeq + m_segments.back().count;
+    if (!startSegment(nextSeq)) {
+        m_segments.clear();
+        return false;
+    }
+    return true;
+}
+
+void LogSpool::close() {
+    for (Segment& segment : m_segments) {
+        unmapSegment(segment);
+    }
+    m_segments.clear();
+    m_open = false;
+}
+
+bool LogSpool::loadSegment(const std::string& path, Segment& segment) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+
+    SegmentHeader header;
+    struct stat st;
+    bool ours = fstat(fd, &st) == 0 && (size_t)st.st_size == SEGMENT_BYTES
+        && pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+        && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0;
+    ::close(fd);
+
+    if (ours && header.version < VERSION) {
+        // Written by an older build in a format nothing reads any more
+        unlink(path.c_str());
+        return false;
+    }
+    if (!ours || header.version != VERSION
+        || header.used < HEADER_BYTES || header.used > SEGMENT_BYTES
+        || header.indexCount > INDEX_CAPACITY) {
+        return false;
+    }
+
+    segment.path = path;
+    segment.firstSeq = header.firstSeq;
+    segment.count = header.count;
+    segment.firstTime = header.firstTime;
+    segment.lastTime = header.lastTime;
+    return true;
+}
+
+// Keeps appending to the newest segment left by a previous run
+bool LogSpool::resumeSegment(Segment& segment) {
+    int fd = ::open(segment.path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd == -1) return false;
+    void* map = mmap(nullptr, SEGMENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    segment.map = static_cast<char*>(map);
+    m_open = true;
+    return true;
+}
+
+// Segments are created at full size (sparse until written) and stay mapped
+// read-write while they are the append target
+bool LogSpool::startSegment(uint64_t firstSeq) {
+    std::string path = m_dir + "/" + segmentName(firstSeq);
+
+    if (!m_segments.empty() && m_segments.back().firstSeq == firstSeq) {
+        // Empty leftover from a previous run; reuse it
+        unmapSegment(m_segments.back());
+        m_segments.pop_back();
+    }
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) return false;
+
+    if (ftruncate(fd, SEGMENT_BYTES) == -1) {
+        ::close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    void* map = mmap(nullptr, SEGMENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        unlink(path.c_str());
+        return false;
+    }
+
+    Segment segment;
+    segment.path = path;
+    segment.firstSeq = firstSeq;
+    segment.map = static_cast<char*>(map);
+
+    SegmentHeader* header = headerOf(segment.map);
+    memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->indexCount = 0;
+    header->firstSeq = firstSeq;
+    header->count = 0;
+    header->used = HEADER_BYTES;
+    header->firstTime = 0;
+    header->lastTime = 0;
+
+    m_segments.push_back(std::move(segment));
+    m_open = true;
+    return true;
+}
+
+// The active segment becomes read-only history; its map is dropped so it
+// is only paged back in when someone scrolls to it
+void LogSpool::finishActive() {
+    if (!m_open) return;
+    Segment& active = m_segments.back();
+    msync(active.map, HEADER_BYTES, MS_ASYNC);
+    unmapSegment(active);
+    m_open = false;
+}
+
+void LogSpool::append(std::string_view line, int64_t time) {
+    if (!m_open) return;
+
+    if (line.size() > MAX_LINE_BYTES) {
+        line = line.substr(0, MAX_LINE_BYTES);
+    }
+    size_t need = sizeof(RecordHeader) + line.size();
+
+    SegmentHeader* header = headerOf(m_segments.back().map);
+    bool needsIndex = header->count % INDEX_STRIDE == 0;
+    if (header->used + need > SEGMENT_BYTES || (needsIndex && header->indexCount == INDEX_CAPACITY)) {
+        uint64_t nextSeq = header->firstSeq + header->count;
+        finishActive();
+        enforceRetention(time);
+        if (!startSegment(nextSeq)) {
+            return;  // Disk trouble; history stops here
+        }
+        header = headerOf(m_segments.back().map);
+        needsIndex = true;
+    }
+
+    char* map = m_segments.back().map;
+    if (needsIndex) {
+        IndexEntry& entry = indexOf(map)[header->indexCount];
+        entry.time = time;
+        entry.offset = (uint32_t)header->used;
+        entry.reserved = 0;
+        header->indexCount++;
+    }
+
+    RecordHeader record = { time, (uint32_t)line.size(), 0 };
+    memcpy(map + header->used, &record, sizeof(record));
+    memcpy(map + header->used + sizeof(record), line.data(), line.size());
+
+    // Publish the record only after its bytes are in place
+    header->used += need;
+    if (header->count == 0) header->firstTime = time;
+    header->lastTime = time;
+    header->count++;
+
+    Segment& active = m_segments.back();
+    active.count = header->count;
+    if (active.count == 1) active.firstTime = time;
+    active.lastTime = time;
+}
+
+void LogSpool::enforceRetention(int64_t now) {
+    // The append target (if any) is never removed
+    size_t keep = m_open ? 1 : 0;
+    while (m_segments.size() > keep) {
+        bool overSize = (uint64_t)m_segments.size() * SEGMENT_BYTES > MAX_SPOOL_BYTES;
+        bool tooOld = m_segments.front().lastTime < now - MAX_AGE_US;
+        if (!overSize && !tooOld) break;
+        removeOldest();
+    }
+}
+
+void LogSpool::removeOldest() {
+    Segment& oldest = m_segments.front();
+    unmapSegment(oldest);
+    unlink(oldest.path.c_str());
+    m_segments.erase(m_segments.begin());
+}
+
+uint64_t LogSpool::firstSeq() const {
+    return m_segments.empty() ? 0 : m_segments.front().firstSeq;
+}
+
+uint64_t LogSpool::endSeq() const {
+    return m_segments.empty() ? 0 : m_segments.back().firstSeq + m_segments.back().count;
+}
+
+const LogSpool::Segment* LogSpool::findSegment(uint64_t seq) const {
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), seq,
+                               [](uint64_t s, const Segment& segment) { return s < segment.firstSeq; });
+    if (it == m_segments.begin()) return nullptr;
+    --it;
+    if (seq >= it->firstSeq + it->count) return nullptr;
+    return &*it;
+}
+
+// Maps a history segment read-only on demand, dropping the least recently
+// used map once more than MAX_MAPPED are held
+const char* LogSpool::mapSegment(const Segment& segment) const {
+    Segment& target = const_cast<Segment&>(segment);
+    target.lastUse = ++m_useClock;
+    if (target.map) return target.map;
+
+    size_t mapped = 0;
+    Segment* lru = nullptr;
+    for (size_t i = 0; i + (m_open ? 1 : 0) < m_segments.size(); i++) {
+        Segment& other = m_segments[i];
+        if (!other.map || &other == &target) continue;
+        mapped++;
+        if (!lru || other.lastUse < lru->lastUse) lru = &other;
+    }
+    if (mapped >= MAX_MAPPED && lru) {
+        unmapSegment(*lru);
+    }
+
+    int fd = ::open(target.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return nullptr;
+    void* map = mmap(nullptr, SEGMENT_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return nullptr;
+
+    target.map = static_cast<char*>(map);
+    return target.map;
+}
+
+void LogSpool::unmapSegment(Segment& segment) const {
+    if (segment.map) {
+        munmap(segment.map, SEGMENT_BYTES);
+        segment.map = nullptr;
+    }
+}
+
+// Index entry for the line's stride, then a walk of at most INDEX_STRIDE - 1
+// records
+const char* LogSpool::recordAt(const Segment& segment, uint64_t seq) const {
+    const char* map = mapSegment(segment);
+    if (!map) return nullptr;
+
+    uint64_t index = seq - segment.firstSeq;
+    const IndexEntry& entry = indexOf(map)[index / INDEX_STRIDE];
+    const char* record = map + entry.offset;
+    for (uint64_t skip = index % INDEX_STRIDE; skip > 0; skip--) {
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+        record += sizeof(header) + header.length;
+    }
+    return record;
+}
+
+std::string_view LogSpool::line(uint64_t seq) const {
+    const Segment* segment = findSegment(seq);
+    const char* record = segment ? recordAt(*segment, seq) : nullptr;
+    if (!record) return std::string_view();
+
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    return std::string_view(record + sizeof(header), header.length);
+}
+
+int64_t LogSpool::timeOf(uint64_t seq) const {
+    const Segment* segment = findSegment(seq);
+    const char* record = segment ? recordAt(*segment, seq) : nullptr;
+    if (!record) return 0;
+
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    return header.time;
+}
+
+// Linear pass over the (few) segments by time range, then a binary search of
+// the segment's sparse index: the line is in the stride before the first
+// entry at or after `time`, or starts the next one
+uint64_t LogSpool::seqForTime(int64_t time) const {
+    auto it = std::find_if(m_segments.begin(), m_segments.end(),
+                           [time](const Segment& segment) { return segment.count > 0 && segment.lastTime >= time; });
+    if (it == m_segments.end()) return endSeq();
+
+    const Segment& segment = *it;
+    const char* map = mapSegment(segment);
+    if (!map) return segment.firstSeq;
+
+    uint32_t indexCount = headerOf(map)->indexCount;
+    const IndexEntry* index = indexOf(map);
+    const IndexEntry* pos = std::lower_bound(index, index + indexCount, time,
+                                             [](const IndexEntry& entry, int64_t t) { return entry.time < t; });
+    uint64_t stride = (pos == index) ? 0 : (uint64_t)(pos - index - 1);
+
+    uint64_t seq = segment.firstSeq + stride * INDEX_STRIDE;
+    uint64_t end = std::min(seq + INDEX_STRIDE, segment.firstSeq + segment.count);
+    const char* record = map + index[stride].offset;
+    for (; seq < end; seq++) {
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+        if (header.time >= time) break;
+        record += sizeof(header) + header.length;
+    }
+    return seq;
+}
@@ -0,0 +1,113 @@
+#ifndef LOG_SPOOL_HPP
+#define LOG_SPOOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_source.hpp"
+
+// On-disk log history: every line is appended to fixed-size, memory-mapped
+// segment files in one directory. Each segment starts with a header holding
+// a sparse index (one entry per INDEX_STRIDE lines: time and file offset),
+// so any line or point in time is reached by a binary search and a short
+// walk. Only the active segment and a few recently read ones are mapped;
+// the rest are read back through the page cache when scrolled to. Old
+// segments are deleted once the spool exceeds MAX_SPOOL_BYTES or MAX_AGE.
+// Not thread safe; owned by the GUI thread.
+class LogSpool : public LogSource {
+public:
+    LogSpool();
+    ~LogSpool();
+    LogSpool(const LogSpool&) = delete;
+    LogSpool& operator=(const LogSpool&) = delete;
+
+    // Creates the directory if needed and picks up existing segments
+    bool open(const std::string& dir);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    // time is logClockUs(); long lines are truncated
+    void append(std::string_view line, int64_t time);
+
+    uint64_t firstSeq() const override;
+    uint64_t endSeq() const override;
+    std::string_view line(uint64_t seq) const override;
+
+    bool hasTimes() const override { return true; }
+    int64_t timeOf(uint64_t seq) const override;
+    uint64_t seqForTime(int64_t time) const override;
+
+    size_t segmentCount() const { return m_segments.size(); }
+
+private:
+    struct IndexEntry {
+        int64_t time;     // Time of the first line in this stride
+        uint32_t offset;  // File offset of that line's record
+        uint32_t reserved;
+    };
+
+    struct SegmentHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t indexCount;
+        uint64_t firstSeq;
+        uint64_t count;
+        uint64_t used;  // File offset just past the last record
+        int64_t firstTime;
+        int64_t lastTime;
+    };
+
+    struct RecordHeader {
+        int64_t time;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    struct Segment {
+        std::string path;
+        uint64_t firstSeq = 0;
+        uint64_t count = 0;
+        int64_t firstTime = 0;
+        int64_t lastTime = 0;
+        char* map = nullptr;
+        uint64_t lastUse = 0;
+    };
+
+    bool loadSegment(const std::string& path, Segment& segment);
+    bool resumeSegment(Segment& segment);
+    bool startSegment(uint64_t firstSeq);
+    void finishActive();
+    void enforceRetention(int64_t now);
+    void removeOldest();
+
+    const Segment* findSegment(uint64_t seq) const;
+    const char* mapSegment(const Segment& segment) const;
+    void unmapSegment(Segment& segment) const;
+    const char* recordAt(const Segment& segment, uint64_t seq) const;
+
+    static SegmentHeader* headerOf(char* map) { return reinterpret_cast<SegmentHeader*>(map); }
+    static const SegmentHeader* headerOf(const char* map) { return reinterpret_cast<const SegmentHeader*>(map); }
+    static IndexEntry* indexOf(char* map) { return reinterpret_cast<IndexEntry*>(map + sizeof(SegmentHeader)); }
+    static const IndexEntry* indexOf(const char* map) { return reinterpret_cast<const IndexEntry*>(map + sizeof(SegmentHeader)); }
+
+    std::string m_dir;
+    mutable std::vector<Segment> m_segments;  // Oldest first, contiguous seqs
+    bool m_open;  // The last segment is mapped read-write for appends
+    mutable uint64_t m_useClock;
+
+    static constexpr char MAGIC[8] = { 'M', 'M', 'G', 'S', 'P', 'O', 'O', 'L' };
+    static constexpr uint32_t VERSION = 2;  // 2: microsecond times
+    static constexpr size_t SEGMENT_BYTES = 16 * 1024 * 1024;
+    static constexpr size_t HEADER_BYTES = 64 * 1024;  // Header plus sparse index
+    static constexpr size_t INDEX_CAPACITY = (HEADER_BYTES - sizeof(SegmentHeader)) / sizeof(IndexEntry);
+    static constexpr uint64_t INDEX_STRIDE = 64;
+    static constexpr size_t MAX_LINE_BYTES = 64 * 1024;
+    static constexpr size_t MAX_MAPPED = 4;  // Read-only maps kept besides the active one
+    static constexpr uint64_t MAX_SPOOL_BYTES = 1024ull * 1024 * 1024;
+    static constexpr int64_t MAX_AGE_US = 7ll * 24 * 3600 * 1000000;
+};
+
+#endif // LOG_SPOOL_HPP
@@ -0,0 +1,249 @@
+#include "log_store.hpp"
+#include <lz4.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+// Records are a zigzag LEB128 time delta, a LEB128 length, then the bytes.
+// Lines arrive nearly in time order, so the delta is usually one or two bytes.
+static constexpr size_t MAX_RECORD_OVERHEAD = 10 + 5;
+
+static void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+static uint64_t readVarint(const unsigned char*& p) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        value |= (uint64_t)(*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return value | (uint64_t)*p++ << shift;
+}
+
+static void appendRecord(std::string& out, int64_t timeDelta, std::string_view line) {
+    appendVarint(out, ((uint64_t)timeDelta << 1) ^ (uint64_t)(timeDelta >> 63));
+    appendVarint(out, line.size());
+    out.append(line.data(), line.size());
+}
+
+struct Record {
+    int64_t timeDelta;
+    std::string_view text;
+};
+
+static Record readRecord(const char* data, size_t offset) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data + offset);
+    uint64_t zigzag = readVarint(p);
+    size_t length = (size_t)readVarint(p);
+    return { (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1),
+             std::string_view(reinterpret_cast<const char*>(p), length) };
+}
+
+LogBlockCache::LogBlockCache()
+    : m_useClock(0)
+{
+}
+
+void LogBlockCache::clear() {
+    for (Entry& entry : m_entries) {
+        entry.firstSeq = UINT64_MAX;
+        std::vector<char>().swap(entry.raw);
+        std::vector<uint32_t>().swap(entry.offsets);
+        std::vector<int64_t>().swap(entry.times);
+    }
+}
+
+size_t LogBlockCache::memoryBytes() const {
+    size_t bytes = 0;
+    for (const Entry& entry : m_entries) {
+        bytes += entry.raw.capacity() + entry.offsets.capacity() * sizeof(uint32_t)
+                 + entry.times.capacity() * sizeof(int64_t);
+    }
+    return bytes;
+}
+
+LogBlockCache::Entry& LogBlockCache::load(const LogBlock& block) {
+    Entry* victim = &m_entries[0];
+    for (Entry& entry : m_entries) {
+        if (entry.firstSeq == block.firstSeq) {
+            entry.lastUse = ++m_useClock;
+            return entry;
+        }
+        if (entry.lastUse < victim->lastUse) {
+            victim = &entry;
+        }
+    }
+
+    victim->raw.resize(block.rawBytes);
+    int got = LZ4_decompress_safe(block.data.get(), victim->raw.data(),
+                                  (int)block.compressedBytes, (int)block.rawBytes);
+    if (got != (int)block.rawBytes) {
+        // Can't happen for blocks we compressed; show empty lines, not garbage
+        victim->raw.assign(block.count, '\0');
+    }
+
+    // One pass to find where each record starts and when it arrived
+    victim->offsets.clear();
+    victim->offsets.reserve(block.count);
+    victim->times.clear();
+    victim->times.reserve(block.count);
+    size_t offset = 0;
+    int64_t time = block.firstTime;
+    for (uint32_t i = 0; i < block.count && offset < victim->raw.size(); i++) {
+        victim->offsets.push_back((uint32_t)offset);
+        Record record = readRecord(victim->raw.data(), offset);
+        time += record.timeDelta;
+        victim->times.push_back(time);
+        offset = (record.text.data() - victim->raw.data()) + record.text.size();
+    }
+    victim->offsets.resize(block.count, 0);
+    victim->times.resize(block.count, time);
+
+    victim->firstSeq = block.firstSeq;
+    victim->lastUse = ++m_useClock;
+    return *victim;
+}
+
+std::string_view LogBlockCache::line(const LogBlock& block, uint64_t seq) {
+    Entry& entry = load(block);
+    return readRecord(entry.raw.data(), entry.offsets[(size_t)(seq - block.firstSeq)]).text;
+}
+
+int64_t LogBlockCache::timeOf(const LogBlock& block, uint64_t seq) {
+    return load(block).times[(size_t)(seq - block.firstSeq)];
+}
+
+uint64_t LogBlockCache::seqForTime(const LogBlock& block, int64_t time) {
+    const std::vector<int64_t>& times = load(block).times;
+    return block.firstSeq + (uint64_t)(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+}
+
+LogStore::LogStore(size_t budgetBytes)
+    : m_compressedBytes(0)
+    , m_sealedRawBytes(0)
+    , m_openFirstSeq(0)
+    , m_compressCapacity((size_t)LZ4_compressBound((int)(BLOCK_BYTES + MAX_LINE_BYTES + MAX_RECORD_OVERHEAD)))
+    , m_budget(std::max(budgetBytes, MIN_BUDGET))
+{
+    // The text is sized once for the largest block, so appending it never
+    // reallocates; the per-line arrays start at a typical block's line count
+    // and grow for blocks of short lines
+    m_open.reserve(BLOCK_BYTES + MAX_LINE_BYTES + MAX_RECORD_OVERHEAD);
+    m_openOffsets.reserve(4096);
+    m_openTimes.reserve(4096);
+    m_compressBuffer.reset(new char[m_compressCapacity]);
+}
+
+void LogStore::setBudget(size_t budgetBytes) {
+    m_budget = std::max(budgetBytes, MIN_BUDGET);
+    enforceBudget();
+}
+
+LogBlockPtr LogStore::push(std::string_view line, int64_t time) {
+    if (line.size() > MAX_LINE_BYTES) {
+        line = line.substr(0, MAX_LINE_BYTES);
+    }
+
+    int64_t previous = m_openTimes.empty() ? time : m_openTimes.back();
+    m_openOffsets.push_back((uint32_t)m_open.size());
+    m_openTimes.push_back(time);
+    appendRecord(m_open, time - previous, line);
+
+    if (m_open.size() < BLOCK_BYTES && m_openOffsets.size() < BLOCK_MAX_LINES) {
+        return nullptr;
+    }
+    seal();
+    LogBlockPtr sealed = m_sealed.back();
+    enforceBudget();
+    return sealed;
+}
+
+void LogStore::seal() {
+    int compressed = LZ4_compress_default(m_open.data(), m_compressBuffer.get(),
+                                          (int)m_open.size(), (int)m_compressCapacity);
+
+    auto block = std::make_shared<LogBlock>();
+    block->firstSeq = m_openFirstSeq;
+    block->firstTime = m_openTimes.front();
+    block->count = (uint32_t)m_openOffsets.size();
+    block->rawBytes = (uint32_t)m_open.size();
+    block->compressedBytes = (size_t)compressed;
+    block->data.reset(new char[compressed]);
+    memcpy(block->data.get(), m_compressBuffer.get(), compressed);
+
+    m_compressedBytes += block->compressedBytes;
+    m_sealedRawBytes += block->rawBytes;
+    m_sealed.push_back(std::move(block));
+
+    m_openFirstSeq += m_openOffsets.size();
+    m_open.clear();
+    m_openOffsets.clear();
+    m_openTimes.clear();
+}
+
+size_t LogStore::fixedBytes() const {
+    return m_open.capacity() + m_openOffsets.capacity() * sizeof(uint32_t)
+           + m_openTimes.capacity() * sizeof(int64_t) + m_compressCapacity
+           + m_cache.memoryBytes();
+}
+
+size_t LogStore::memoryBytes() const {
+    return fixedBytes() + m_compressedBytes + m_sealed.size() * sizeof(LogBlock);
+}
+
+void LogStore::enforceBudget() {
+    while (!m_sealed.empty() && memoryBytes() > m_budget) {
+        m_compressedBytes -= m_sealed.front()->compressedBytes;
+        m_sealedRawBytes -= m_sealed.front()->rawBytes;
+        m_sealed.pop_front();
+    }
+}
+
+uint64_t LogStore::firstSeq() const {
+    return m_sealed.empty() ? m_openFirstSeq : m_sealed.front()->firstSeq;
+}
+
+std::string_view LogStore::line(uint64_t seq) const {
+    if (seq >= m_openFirstSeq) {
+        return readRecord(m_open.data(), m_openOffsets[(size_t)(seq - m_openFirstSeq)]).text;
+    }
+    const LogBlock* block = blockFor(seq);
+    return block ? m_cache.line(*block, seq) : std::string_view();
+}
+
+int64_t LogStore::timeOf(uint64_t seq) const {
+    if (seq >= m_openFirstSeq) {
+        return m_openTimes[(size_t)(seq - m_openFirstSeq)];
+    }
+    const LogBlock* block = blockFor(seq);
+    return block ? m_cache.timeOf(*block, seq) : 0;
+}
+
+// Last block that starts at or before time, then the first line in it (or
+// after it) stamped at or after time
+uint64_t LogStore::seqForTime(int64_t time) const {
+    if (m_sealed.empty() || (!m_openTimes.empty() && m_openTimes.front() <= time)) {
+        auto it = std::lower_bound(m_openTimes.begin(), m_openTimes.end(), time);
+        return m_openFirstSeq + (uint64_t)(it - m_openTimes.begin());
+    }
+
+    auto it = std::upper_bound(m_sealed.begin(), m_sealed.end(), time,
+                               [](int64_t t, const LogBlockPtr& block) { return t < block->firstTime; });
+    if (it == m_sealed.begin()) return firstSeq();
+    return m_cache.seqForTime(**(it - 1), time);
+}
+
+// Last block starting at or before seq; null for a seq already evicted
+const LogBlock* LogStore::blockFor(uint64_t seq) const {
+    auto it = std::upper_bound(m_sealed.begin(), m_sealed.end(), seq,
+                               [](uint64_t s, const LogBlockPtr& block) { return s < block->firstSeq; });
+    assert(it != m_sealed.begin() && "seq below firstSeq()");
+    if (it == m_sealed.begin()) return nullptr;
+    return (it - 1)->get();
+}
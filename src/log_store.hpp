@@ -0,0 +1,123 @@
+#ifndef LOG_STORE_HPP
+#define LOG_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_source.hpp"
+
+// A run of consecutive lines, LZ4-compressed. The payload is a sequence of
+// records: a varint time delta from the previous line (firstTime for the
+// first), a varint length and the bytes. Immutable once sealed, so other
+// threads (the log search) can hold on to it.
+struct LogBlock {
+    uint64_t firstSeq = 0;
+    int64_t firstTime = 0;
+    uint32_t count = 0;
+    uint32_t rawBytes = 0;  // Payload size before compression
+    size_t compressedBytes = 0;
+    std::unique_ptr<char[]> data;
+
+    uint64_t endSeq() const { return firstSeq + count; }
+};
+
+using LogBlockPtr = std::shared_ptr<const LogBlock>;
+
+// Decompressed copies of the most recently read blocks. One per reading
+// thread; a returned view stays valid until CACHE_BLOCKS other blocks have
+// been read through the same cache.
+class LogBlockCache {
+public:
+    LogBlockCache();
+    std::string_view line(const LogBlock& block, uint64_t seq);
+    int64_t timeOf(const LogBlock& block, uint64_t seq);
+
+    // First line in the block stamped at or after time, else endSeq()
+    uint64_t seqForTime(const LogBlock& block, int64_t time);
+
+    void clear();
+    size_t memoryBytes() const;
+
+    static constexpr size_t CACHE_BLOCKS = 4;
+
+private:
+    struct Entry {
+        uint64_t firstSeq = UINT64_MAX;  // Identifies the block; seqs are never reused
+        uint64_t lastUse = 0;
+        std::vector<char> raw;
+        std::vector<uint32_t> offsets;  // Record starts
+        std::vector<int64_t> times;      // Decoded from the deltas
+    };
+
+    Entry& load(const LogBlock& block);
+
+    Entry m_entries[CACHE_BLOCKS];
+    uint64_t m_useClock;
+};
+
+// In-memory log scrollback bounded by bytes. Lines are appended to an
+// uncompressed open block; once it holds BLOCK_BYTES it is compressed
+// with LZ4 and sealed. Sealed blocks are only decompressed when a line in
+// them is read, and the oldest are dropped to stay within the budget.
+// Not thread safe; owned by the GUI thread.
+class LogStore : public LogSource {
+public:
+    explicit LogStore(size_t budgetBytes);
+    LogStore(const LogStore&) = delete;
+    LogStore& operator=(const LogStore&) = delete;
+
+    void setBudget(size_t budgetBytes);
+    size_t budget() const { return m_budget; }
+
+    // time is logClockUs() at ingest. Long lines are truncated to
+    // MAX_LINE_BYTES. Returns the block this line's arrival sealed, if any.
+    LogBlockPtr push(std::string_view line, int64_t time);
+
+    uint64_t firstSeq() const override;
+    uint64_t endSeq() const override { return m_openFirstSeq + m_openOffsets.size(); }
+    std::string_view line(uint64_t seq) const override;
+
+    bool hasTimes() const override { return true; }
+    int64_t timeOf(uint64_t seq) const override;
+    uint64_t seqForTime(int64_t time) const override;
+
+    // Resident bytes (compressed blocks, open block, decompression cache)
+    // and the text they hold
+    size_t memoryBytes() const;
+    uint64_t textBytes() const { return m_sealedRawBytes + m_open.size(); }
+    size_t blockCount() const { return m_sealed.size(); }
+
+    static constexpr size_t BLOCK_BYTES = 256 * 1024;
+    static constexpr size_t BLOCK_MAX_LINES = 65535;
+    static constexpr size_t MAX_LINE_BYTES = 64 * 1024;
+    static constexpr size_t MIN_BUDGET = 4 * 1024 * 1024;
+
+private:
+    void seal();
+    void enforceBudget();
+    size_t fixedBytes() const;
+    const LogBlock* blockFor(uint64_t seq) const;
+
+    std::deque<LogBlockPtr> m_sealed;  // Oldest first, contiguous seqs
+    size_t m_compressedBytes;
+    uint64_t m_sealedRawBytes;
+
+    // Open block: records as they will be compressed, plus their offsets
+    // and times
+    std::string m_open;
+    std::vector<uint32_t> m_openOffsets;
+    std::vector<int64_t> m_openTimes;
+    uint64_t m_openFirstSeq;
+
+    std::unique_ptr<char[]> m_compressBuffer;
+    size_t m_compressCapacity;
+    mutable LogBlockCache m_cache;
+    size_t m_budget;
+};
+
+#endif // LOG_STORE_HPP
@@ -0,0 +1,450 @@
+#include "log_view.hpp"
+#include <FL/Fl.H>
+#include <algorithm>
+
+LogView::LogView(int x, int y, int w, int h)
+    : Fl_Group(x, y, w, h)
+    , m_source(nullptr)
+    , m_scrollbar(nullptr)
+    , m_font(FL_COURIER)
+    , m_size(11)
+    , m_lineHeight(13)
+    , m_charWidth(7)
+    , m_cols(1)
+    , m_metricsValid(false)
+    , m_top{0, 0}
+    , m_rowCache(ROW_CACHE_SLOTS)
+    , m_layoutEpoch(1)
+    , m_selAnchor(UINT64_MAX)
+    , m_selEnd(UINT64_MAX)
+{
+    box(FL_DOWN_BOX);
+    color(FL_WHITE);
+    selection_color(FL_SELECTION_COLOR);
+
+    int sbW = Fl::scrollbar_size();
+    m_scrollbar = new Fl_Scrollbar(x + w - sbW, y, sbW, h);
+    m_scrollbar->type(FL_VERTICAL);
+    m_scrollbar->callback(onScrollbar, this);
+    m_scrollbar->linesize(1);
+
+    end();
+    resizable(nullptr);
+}
+
+void LogView::setSource(const LogSource* source) {
+    m_source = source;
+    m_layoutEpoch++;  // Cached counts belong to the old source's lines
+    m_top = { source ? source->firstSeq() : 0, 0 };
+    m_selAnchor = m_selEnd = UINT64_MAX;
+    updateScrollbar();
+    redraw();
+}
+
+void LogView::textfont(Fl_Font font) {
+    m_font = font;
+    invalidateLayout();
+}
+
+void LogView::textsize(Fl_Fontsize size) {
+    m_size = size;
+    invalidateLayout();
+}
+
+void LogView::resize(int x, int y, int w, int h) {
+    int oldTextW = textW();
+    Fl_Widget::resize(x, y, w, h);
+
+    int sbW = Fl::scrollbar_size();
+    m_scrollbar->resize(x + w - sbW, y, sbW, h);
+
+    if (textW() != oldTextW) {
+        invalidateLayout();
+    }
+    updateScrollbar();
+}
+
+void LogView::onScrollbar(Fl_Widget* w, void* data) {
+    LogView* view = static_cast<LogView*>(data);
+    Fl_Scrollbar* sb = static_cast<Fl_Scrollbar*>(w);
+    if (!view->m_source) return;
+
+    if (sb->value() >= sb->maximum()) {
+        view->scrollToBottom();
+    } else {
+        view->m_top = { view->m_source->firstSeq() + (uint64_t)sb->value(), 0 };
+        view->redraw();
+    }
+    view->userScrolled();
+}
+
+void LogView::updateMetrics() {
+    if (m_metricsValid) return;
+
+    fl_font(m_font, m_size);
+    m_lineHeight = std::max(1, fl_height());
+    m_charWidth = std::max(1, (int)fl_width("M"));
+    m_cols = std::max(1, textW() / m_charWidth);
+    m_metricsValid = true;
+}
+
+// Row counts depend on the width and font; bumping the epoch drops every
+// cached count without touching the cache itself
+void LogView::invalidateLayout() {
+    m_metricsValid = false;
+    m_layoutEpoch++;
+    redraw();
+}
+
+int LogView::textW() const {
+    return std::max(1, w() - Fl::scrollbar_size() - MARGIN * 2);
+}
+
+int LogView::visibleRows() const {
+    return std::max(1, textH() / m_lineHeight);
+}
+
+std::string_view LogView::displayText(uint64_t seq) {
+    std::string_view line = m_source->line(seq);
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+        line.remove_suffix(1);
+    }
+    if (!m_source->hasTimes()) return line;
+
+    char stamp[LogTimeFormat::LENGTH];
+    m_timeFormat.format(m_source->timeOf(seq), stamp);
+    m_lineBuffer.assign(1, '[');
+    m_lineBuffer.append(stamp, sizeof(stamp));
+    m_lineBuffer.append("] ", 2);
+    m_lineBuffer.append(line.data(), line.size());
+    return m_lineBuffer;
+}
+
+// Byte offset just past the row that starts at `start`. Counts UTF-8 code
+// points against the column limit and breaks after the last space that fits,
+// falling back to a hard break for long words. Used for both measuring and
+// drawing so cached row counts always match what is drawn.
+size_t LogView::rowEnd(std::string_view text, size_t start) const {
+    size_t pos = start;
+    size_t breakAfter = std::string_view::npos;
+    int cols = 0;
+
+    while (pos < text.size() && cols < m_cols) {
+        if (text[pos] == ' ') {
+            breakAfter = pos + 1;
+        }
+        pos++;
+        while (pos < text.size() && ((unsigned char)text[pos] & 0xC0) == 0x80) {
+            pos++;
+        }
+        cols++;
+    }
+
+    if (pos < text.size() && text[pos] != ' ' && breakAfter != std::string_view::npos) {
+        return breakAfter;
+    }
+    return pos;
+}
+
+int LogView::rowsFor(uint64_t seq) {
+    RowCacheEntry& entry = m_rowCache[seq % m_rowCache.size()];
+    if (entry.seq == seq && entry.epoch == m_layoutEpoch) {
+        return entry.rows;
+    }
+
+    std::string_view text = displayText(seq);
+    int rows = 1;
+    size_t pos = rowEnd(text, 0);
+    while (pos < text.size()) {
+        pos = rowEnd(text, pos);
+        rows++;
+    }
+
+    entry.seq = seq;
+    entry.epoch = m_layoutEpoch;
+    entry.rows = rows;
+    return rows;
+}
+
+void LogView::clampTop() {
+    if (!m_source || m_source->empty()) {
+        m_top = { m_source ? m_source->endSeq() : 0, 0 };
+        return;
+    }
+    if (m_top.seq < m_source->firstSeq()) {
+        // Top line was evicted
+        m_top = { m_source->firstSeq(), 0 };
+    } else if (m_top.seq >= m_source->endSeq()) {
+        m_top = { m_source->endSeq() - 1, 0 };
+    }
+    m_top.row = std::min(m_top.row, rowsFor(m_top.seq) - 1);
+}
+
+// Top position that puts the last row at the bottom of the view; walks
+// back over the visible rows only
+LogView::Position LogView::bottomPosition() {
+    uint64_t first = m_source->firstSeq();
+    uint64_t seq = m_source->endSeq();
+    int needed = visibleRows();
+
+    while (seq > first) {
+        seq--;
+        int rows = rowsFor(seq);
+        if (rows >= needed) {
+            return { seq, rows - needed };
+        }
+        needed -= rows;
+    }
+    return { first, 0 };
+}
+
+void LogView::scrollRows(int delta) {
+    if (!m_source || m_source->empty()) return;
+    updateMetrics();
+    clampTop();
+
+    if (delta > 0) {
+        Position limit = bottomPosition();
+        while (delta-- > 0 && m_top < limit) {
+            if (m_top.row + 1 < rowsFor(m_top.seq)) {
+                m_top.row++;
+            } else {
+                m_top = { m_top.seq + 1, 0 };
+            }
+        }
+    } else {
+        while (delta++ < 0) {
+            if (m_top.row > 0) {
+                m_top.row--;
+            } else if (m_top.seq > m_source->firstSeq()) {
+                m_top.seq--;
+                m_top.row = rowsFor(m_top.seq) - 1;
+            } else {
+                break;
+            }
+        }
+    }
+
+    updateScrollbar();
+    redraw();
+}
+
+void LogView::linesChanged() {
+    if (!m_source) return;
+
+    // Selection may have been evicted
+    if (m_selAnchor != UINT64_MAX && std::max(m_selAnchor, m_selEnd) < m_source->firstSeq()) {
+        m_selAnchor = m_selEnd = UINT64_MAX;
+    }
+
+    updateMetrics();
+    clampTop();
+    updateScrollbar();
+    redraw();
+}
+
+void LogView::scrollToBottom() {
+    if (!m_source || m_source->empty()) return;
+    updateMetrics();
+    m_top = bottomPosition();
+    updateScrollbar();
+    redraw();
+}
+
+bool LogView::isAtBottom() {
+    if (!m_source || m_source->empty()) return true;
+    updateMetrics();
+    clampTop();
+    return !(m_top < bottomPosition());
+}
+
+void LogView::updateScrollbar() {
+    if (!m_scrollbar) return;
+
+    int total = m_source ? (int)m_source->lineCount() : 0;
+    int window = visibleRows();
+    int top = (m_source && total > 0) ? (int)(m_top.seq - m_source->firstSeq()) : 0;
+    m_scrollbar->value(top, window, 0, std::max(total, window));
+}
+
+void LogView::userScrolled() {
+    if (m_scrollCallback) {
+        m_scrollCallback(isAtBottom());
+    }
+}
+
+void LogView::draw() {
+    updateMetrics();
+
+    fl_push_clip(x(), y(), w() - Fl::scrollbar_size(), h());
+    fl_draw_box(box(), x(), y(), w() - Fl::scrollbar_size(), h(), color());
+
+    m_drawnRows.clear();
+    if (m_source && !m_source->empty()) {
+        clampTop();
+
+        uint64_t selLo = std::min(m_selAnchor, m_selEnd);
+        uint64_t selHi = m_selAnchor == UINT64_MAX ? 0 : std::max(m_selAnchor, m_selEnd);
+
+        fl_font(m_font, m_size);
+        int rowsLeft = visibleRows();
+        int rowY = textY();
+        uint64_t seq = m_top.seq;
+        int skipRows = m_top.row;
+
+        // One row of margin below the last full row, if it is partly visible
+        if (textH() % m_lineHeight) rowsLeft++;
+
+        while (rowsLeft > 0 && seq < m_source->endSeq()) {
+            std::string_view text = displayText(seq);
+            bool selected = seq >= selLo && seq <= selHi;
+
+            size_t start = 0;
+            do {
+                size_t end = rowEnd(text, start);
+                if (skipRows > 0) {
+                    skipRows--;
+                } else {
+                    if (selected) {
+                        fl_rectf(textX(), rowY, textW(), m_lineHeight, selection_color());
+                    }
+                    fl_color(selected ? fl_contrast(FL_BLACK, selection_color()) : FL_BLACK);
+                    fl_draw(text.data() + start, (int)(end - start), textX(), rowY + m_lineHeight - fl_descent());
+
+                    m_drawnRows.push_back(seq);
+                    rowY += m_lineHeight;
+                    rowsLeft--;
+                }
+                start = end;
+            } while (start < text.size() && rowsLeft > 0);
+
+            seq++;
+        }
+    }
+
+    fl_pop_clip();
+    draw_child(*m_scrollbar);
+}
+
+uint64_t LogView::seqAt(int eventY) const {
+    if (m_drawnRows.empty()) return UINT64_MAX;
+    int row = (eventY - textY()) / m_lineHeight;
+    row = std::max(0, std::min(row, (int)m_drawnRows.size() - 1));
+    return m_drawnRows[row];
+}
+
+std::string LogView::selectionText() {
+    std::string text;
+    if (!m_source || m_selAnchor == UINT64_MAX) return text;
+
+    uint64_t lo = std::max(std::min(m_selAnchor, m_selEnd), m_source->firstSeq());
+    uint64_t hi = std::min(std::max(m_selAnchor, m_selEnd), m_source->endSeq() - 1);
+    for (uint64_t seq = lo; seq <= hi && seq < m_source->endSeq(); seq++) {
+        std::string_view line = displayText(seq);
+        text.append(line.data(), line.size());
+        text += '\n';
+    }
+    return text;
+}
+
+void LogView::copySelection(int clipboard) {
+    std::string text = selectionText();
+    if (!text.empty()) {
+        Fl::copy(text.c_str(), (int)text.size(), clipboard);
+    }
+}
+
+int LogView::handle(int event) {
+    switch (event) {
+        case FL_MOUSEWHEEL:
+            if (!Fl::event_inside(this)) return 0;
+            scrollRows(Fl::event_dy() * WHEEL_ROWS);
+            userScrolled();
+            return 1;
+
+        case FL_PUSH:
+            if (Fl::event_inside(m_scrollbar)) break;
+            take_focus();
+            m_selAnchor = m_selEnd = seqAt(Fl::event_y());
+            redraw();
+            return 1;
+
+        case FL_DRAG:
+            if (m_selAnchor == UINT64_MAX) break;
+            // Dragging past an edge scrolls the selection along
+            if (Fl::event_y() < textY()) {
+                scrollRows(-1);
+                userScrolled();
+            } else if (Fl::event_y() >= textY() + textH()) {
+                scrollRows(1);
+                userScrolled();
+            }
+            m_selEnd = seqAt(Fl::event_y());
+            redraw();
+            return 1;
+
+        case FL_RELEASE:
+            if (m_selAnchor == UINT64_MAX) break;
+            copySelection(0);  // Primary selection, as text widgets do
+            return 1;
+
+        case FL_FOCUS:
+        case FL_UNFOCUS:
+            return 1;
+
+        case FL_KEYBOARD: {
+            int key = Fl::event_key();
+            if ((Fl::event_state() & FL_CTRL) && (key == 'c' || key == FL_Insert)) {
+                copySelection(1);
+                return 1;
+            }
+            if ((Fl::event_state() & FL_CTRL) && key == 'a' && m_source && !m_source->empty()) {
+                m_selAnchor = m_source->firstSeq();
+                m_selEnd = m_source->endSeq() - 1;
+                redraw();
+                return 1;
+            }
+
+            if ((Fl::event_state() & FL_CTRL) && (key == FL_Page_Up || key == FL_Page_Down)) {
+                if (!m_source || !m_source->hasTimes() || m_source->empty()) return 0;
+                clampTop();
+                int64_t target = m_source->timeOf(m_top.seq) + (key == FL_Page_Up ? -JUMP_US : JUMP_US);
+                uint64_t seq = m_source->seqForTime(target);
+                if (seq >= m_source->endSeq()) {
+                    scrollToBottom();
+                } else {
+                    m_top = { seq, 0 };
+                    updateScrollbar();
+                    redraw();
+                }
+                userScrolled();
+                return 1;
+            }
+
+            int delta = 0;
+            switch (key) {
+                case FL_Up:        delta = -1; break;
+                case FL_Down:      delta = 1; break;
+                case FL_Page_Up:   delta = -visibleRows(); break;
+                case FL_Page_Down: delta = visibleRows(); break;
+                case FL_Home:
+                    m_top = { m_source ? m_source->firstSeq() : 0, 0 };
+                    updateScrollbar();
+                    redraw();
+                    userScrolled();
+                    return 1;
+                case FL_End:
+                    scrollToBottom();
+                    userScrolled();
+                    return 1;
+                default:
+                    return 0;
+            }
+            scrollRows(delta);
+            userScrolled();
+            return 1;
+        }
+    }
+
+    return Fl_Group::handle(event);
+}
@@ -0,0 +1,120 @@
+#ifndef LOG_VIEW_HPP
+#define LOG_VIEW_HPP
+
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Scrollbar.H>
+#include <FL/fl_draw.H>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_line.hpp"
+#include "log_source.hpp"
+
+// Read-only, word-wrapping log viewer that draws straight from a LogSource
+// (the in-memory store or the on-disk spool). Lines from sources that record
+// times get a "[HH:MM:SS.mmm]" prefix, formatted only as they are drawn.
+// Only the lines on screen are laid out; each line's wrapped row count is
+// cached by sequence number until the width or font changes, so scrolling
+// costs the same with ten lines retained or a million. The scrollbar moves by whole lines. Mouse drag
+// selects lines, Ctrl+C copies them; Ctrl+PgUp/PgDn jump an hour on sources
+// that record times.
+class LogView : public Fl_Group {
+public:
+    LogView(int x, int y, int w, int h);
+
+    void setSource(const LogSource* source);
+    const LogSource* source() const { return m_source; }
+    void textfont(Fl_Font font);
+    void textsize(Fl_Fontsize size);
+
+    // Call after the source changes; updates the scrollbar and redraws
+    void linesChanged();
+    void scrollToBottom();
+    bool isAtBottom();
+    uint64_t topSeq() const { return m_top.seq; }
+
+    // Called after the user scrolls, with whether the view is at the bottom
+    void setScrollCallback(std::function<void(bool)> callback) { m_scrollCallback = callback; }
+
+    int handle(int event) override;
+    void draw() override;
+    void resize(int x, int y, int w, int h) override;
+
+private:
+    // First visible row: a line and a wrapped row within it
+    struct Position {
+        uint64_t seq;
+        int row;
+        bool operator<(const Position& other) const {
+            return seq < other.seq || (seq == other.seq && row < other.row);
+        }
+    };
+
+    struct RowCacheEntry {
+        uint64_t seq = UINT64_MAX;
+        uint32_t epoch = 0;
+        int rows = 0;
+    };
+
+    static void onScrollbar(Fl_Widget* w, void* data);
+
+    void updateMetrics();
+    void invalidateLayout();
+    int textX() const { return x() + MARGIN; }
+    int textY() const { return y() + MARGIN; }
+    int textW() const;
+    int textH() const { return h() - MARGIN * 2; }
+    int visibleRows() const;
+
+    // The line as shown, time prefix included; valid until the next call
+    std::string_view displayText(uint64_t seq);
+    size_t rowEnd(std::string_view text, size_t start) const;
+    int rowsFor(uint64_t seq);
+
+    void clampTop();
+    Position bottomPosition();
+    void scrollRows(int delta);
+    void updateScrollbar();
+    void userScrolled();
+
+    uint64_t seqAt(int eventY) const;
+    std::string selectionText();
+    void copySelection(int clipboard);
+
+    const LogSource* m_source;
+    Fl_Scrollbar* m_scrollbar;
+    std::function<void(bool)> m_scrollCallback;
+
+    Fl_Font m_font;
+    Fl_Fontsize m_size;
+    int m_lineHeight;
+    int m_charWidth;
+    int m_cols;
+    bool m_metricsValid;
+
+    Position m_top;
+
+    LogTimeFormat m_timeFormat;
+    std::string m_lineBuffer;  // Backs displayText()
+
+    // Wrapped row counts, direct-mapped by seq % ROW_CACHE_SLOTS
+    std::vector<RowCacheEntry> m_rowCache;
+    uint32_t m_layoutEpoch;
+
+    // Sequence number of each row drawn last time, for hit testing
+    std::vector<uint64_t> m_drawnRows;
+
+    // Selected lines, inclusive; UINT64_MAX when nothing is selected
+    uint64_t m_selAnchor;
+    uint64_t m_selEnd;
+
+    static constexpr int MARGIN = 3;
+    static constexpr int WHEEL_ROWS = 3;
+    static constexpr int64_t JUMP_US = 3600ll * 1000000;  // Ctrl+PgUp/PgDn on timed sources
+    static constexpr size_t ROW_CACHE_SLOTS = 1 << 14;
+};
+
+#endif // LOG_VIEW_HPP
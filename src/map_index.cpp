@@ -0,0 +1,167 @@
+#include "map_index.hpp"
+#include <dirent.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+MapIndex::MapIndex()
+    : m_snapshot(std::make_shared<const std::vector<std::string>>())
+    , m_version(0)
+    , m_scanUs(0)
+    , m_inotifyFd(-1)
+{
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+}
+
+MapIndex::~MapIndex() {
+    stop();
+}
+
+bool MapIndex::start(const std::string& mapsDir, std::function<void()> onChange) {
+    if (m_thread.joinable()) return true;
+
+    if (pipe(m_wakePipe) == -1) {
+        return false;
+    }
+
+    m_mapsDir = mapsDir;
+    m_onChange = std::move(onChange);
+    m_thread = std::thread(&MapIndex::indexerMain, this);
+    return true;
+}
+
+void MapIndex::stop() {
+    if (m_thread.joinable()) {
+        // The indexer only exits once woken, so retry an interrupted write;
+        // the pipe is empty and its reader open, so nothing else can fail
+        char c = 0;
+        while (write(m_wakePipe[1], &c, 1) == -1 && errno == EINTR) {
+        }
+        m_thread.join();
+    }
+
+    if (m_wakePipe[0] != -1) { close(m_wakePipe[0]); m_wakePipe[0] = -1; }
+    if (m_wakePipe[1] != -1) { close(m_wakePipe[1]); m_wakePipe[1] = -1; }
+}
+
+bool MapIndex::mapNameFromFile(const char* file, std::string& out) {
+    size_t len = strlen(file);
+
+    // Check for .bsp extension
+    if (len <= 4 || strcasecmp(file + len - 4, ".bsp") != 0) {
+        return false;
+    }
+
+    // Map name without .bsp extension, capped like the engine's map names
+    size_t mapLen = len - 4;
+    if (mapLen > 63) mapLen = 63;
+    out.assign(file, mapLen);
+    return true;
+}
+
+void MapIndex::indexerMain() {
+    // Watch before scanning so nothing added mid-scan is missed; the set
+    // absorbs duplicates
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd != -1 &&
+        inotify_add_watch(m_inotifyFd, m_mapsDir.c_str(),
+                          IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) == -1) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+
+    auto scanStart = std::chrono::steady_clock::now();
+    scan();
+    int64_t scanUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - scanStart).count();
+    m_scanUs.store(scanUs > 0 ? scanUs : 1, std::memory_order_relaxed);
+    publish();
+
+    pollfd fds[2];
+    fds[0].fd = m_wakePipe[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = m_inotifyFd;  // Ignored by poll when -1
+    fds[1].events = POLLIN;
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+        if (fds[1].revents) readEvents();
+    }
+
+    if (m_inotifyFd != -1) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+}
+
+void MapIndex::scan() {
+    m_names.clear();
+
+    DIR* dir = opendir(m_mapsDir.c_str());
+    if (!dir) return;
+
+    std::string name;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (mapNameFromFile(entry->d_name, name)) {
+            m_names.insert(name);
+        }
+    }
+    closedir(dir);
+}
+
+void MapIndex::readEvents() {
+    alignas(struct inotify_event) char buffer[8192];
+    bool changed = false;
+    bool overflow = false;
+    std::string name;
+
+    ssize_t len;
+    while ((len = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            if (ev->len == 0 || (ev->mask & IN_ISDIR)) continue;
+            if (!mapNameFromFile(ev->name, name)) continue;
+
+            if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                changed |= m_names.insert(name).second;
+            } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                changed |= m_names.erase(name) > 0;
+            }
+        }
+    }
+
+    if (overflow) {
+        // Lost events; rebuild from scratch
+        scan();
+        changed = true;
+    }
+
+    if (changed) {
+        publish();
+    }
+}
+
+void MapIndex::publish() {
+    auto list = std::make_shared<const std::vector<std::string>>(m_names.begin(), m_names.end());
+    std::atomic_store(&m_snapshot, Snapshot(std::move(list)));
+    m_version.fetch_add(1, std::memory_order_release);
+
+    if (m_onChange) {
+        m_onChange();
+    }
+}
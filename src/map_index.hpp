@@ -0,0 +1,56 @@
+#ifndef MAP_INDEX_HPP
+#define MAP_INDEX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Index of <gamedir>/maps/*.bsp built on a background thread and kept
+// current with inotify add/remove events. Readers get an immutable,
+// sorted snapshot; a new one is published after each batch of changes.
+class MapIndex {
+public:
+    using Snapshot = std::shared_ptr<const std::vector<std::string>>;
+
+    MapIndex();
+    ~MapIndex();
+    MapIndex(const MapIndex&) = delete;
+    MapIndex& operator=(const MapIndex&) = delete;
+
+    // onChange runs on the indexer thread after each publish
+    bool start(const std::string& mapsDir, std::function<void()> onChange);
+    void stop();
+
+    // Safe from any thread
+    Snapshot snapshot() const { return std::atomic_load(&m_snapshot); }
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+    // Duration of the initial directory scan; 0 until it has finished
+    int64_t scanUs() const { return m_scanUs.load(std::memory_order_relaxed); }
+
+private:
+    void indexerMain();
+    void scan();
+    void readEvents();
+    void publish();
+    static bool mapNameFromFile(const char* file, std::string& out);
+
+    std::string m_mapsDir;
+    std::set<std::string> m_names;  // Indexer thread only
+
+    Snapshot m_snapshot;
+    std::atomic<uint64_t> m_version;
+    std::atomic<int64_t> m_scanUs;
+
+    std::thread m_thread;
+    std::function<void()> m_onChange;
+    int m_inotifyFd;
+    int m_wakePipe[2];
+};
+
+#endif // MAP_INDEX_HPP
@@ -48,7 +48,9 @@ META_FUNCTIONS gMetaFunctionTable =
 
 void gui_open_cmd() {
 	g_engfuncs.pfnServerPrint("MetamodGUI: Opening GUI window...\n");
-	FltkGUI::getInstance().show();
+	if (!FltkGUI::getInstance().show()) {
+		g_engfuncs.pfnServerPrint("MetamodGUI: No display available ($DISPLAY unset or METAMOD_GUI_HEADLESS set)\n");
+	}
 }
 
 void gui_close_cmd() {
@@ -56,6 +58,33 @@ void gui_close_cmd() {
 	FltkGUI::getInstance().hide();
 }
 
+void gui_stats_cmd() {
+	FltkGUI::getInstance().printStats();
+}
+
+void gui_log_sink_cmd() {
+	std::vector<std::string> args;
+	for (int i = 1; i < CMD_ARGC(); i++) {
+		args.push_back(CMD_ARGV(i));
+	}
+	FltkGUI::getInstance().logSinkCommand(args);
+}
+
+// Per-frame time budget for GUI work on the game thread, in microseconds (0 = unlimited)
+cvar_t gui_frame_budget_us = { "gui_frame_budget_us", "200", FCVAR_EXTDLL, 0, NULL };
+
+// Log lines per second admitted from each source (0 = unlimited)
+cvar_t gui_log_rate = { "gui_log_rate", "200", FCVAR_EXTDLL, 0, NULL };
+
+// Memory for the in-memory log scrollback, in bytes (compressed blocks included)
+cvar_t gui_log_memory = { "gui_log_memory", "16777216", FCVAR_EXTDLL, 0, NULL };
+
+// Interval between player samples (ping history, table refresh), in milliseconds
+cvar_t gui_player_sample_ms = { "gui_player_sample_ms", "1000", FCVAR_EXTDLL, 0, NULL };
+
+// Lets file and json log sinks write outside addons/metamod-gui/logs; read once, on the first frame
+cvar_t gui_log_sink_any_path = { "gui_log_sink_any_path", "0", FCVAR_EXTDLL, 0, NULL };
+
 C_DLLEXPORT int Meta_Attach(PLUG_LOADTIME now, META_FUNCTIONS *pFunctionTable, meta_globals_t *pMGlobals, gamedll_funcs_t *pGamedllFuncs)
 {
 	gpMetaGlobals = pMGlobals;
@@ -63,21 +92,32 @@ C_DLLEXPORT int Meta_Attach(PLUG_LOADTIME now, META_FUNCTIONS *pFunctionTable, m
 
 	g_engfuncs.pfnServerPrint("\n######################\n# MetamodGUI Loaded! #\n######################\n\n");
 
-	// Initialize FLTK GUI
+	CVAR_REGISTER(&gui_frame_budget_us);
+	CVAR_REGISTER(&gui_log_rate);
+	CVAR_REGISTER(&gui_log_memory);
+	CVAR_REGISTER(&gui_player_sample_ms);
+	CVAR_REGISTER(&gui_log_sink_any_path);
+
+	// Initialize capture and hooks; FLTK stays untouched until a window is opened
 	if (!FltkGUI::getInstance().initialize()) {
 		g_engfuncs.pfnServerPrint("MetamodGUI: Failed to initialize GUI!\n");
 	} else {
 		g_engfuncs.pfnServerPrint("MetamodGUI: GUI initialized successfully\n");
 
-		// Auto-launch the GUI window
-		FltkGUI::getInstance().show();
-		g_engfuncs.pfnServerPrint("MetamodGUI: GUI launched (close window to quit server)\n");
+		// Auto-launch the GUI window when there is a display to put it on
+		if (!FltkGUI::getInstance().show()) {
+			g_engfuncs.pfnServerPrint("MetamodGUI: Running headless; use 'gui_open' once a display is available\n");
+		} else {
+			g_engfuncs.pfnServerPrint("MetamodGUI: GUI launched (close window to quit server)\n");
+		}
 	}
 
 	// Register commands
 	REG_SVR_COMMAND("gui_open", gui_open_cmd);
 	REG_SVR_COMMAND("gui_close", gui_close_cmd);
-	g_engfuncs.pfnServerPrint("MetamodGUI: Registered 'gui_open' and 'gui_close' commands\n");
+	REG_SVR_COMMAND("gui_stats", gui_stats_cmd);
+	REG_SVR_COMMAND("gui_log_sink", gui_log_sink_cmd);
+	g_engfuncs.pfnServerPrint("MetamodGUI: Registered 'gui_open', 'gui_close', 'gui_stats' and 'gui_log_sink' commands\n");
 
 	memcpy(pFunctionTable, &gMetaFunctionTable, sizeof(META_FUNCTIONS));
 	return TRUE;
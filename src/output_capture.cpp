@@ -0,0 +1,233 @@
+#include "output_capture.hpp"
+#include "line_splitter.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+OutputCapture::OutputCapture()
+    : m_active(false)
+    , m_gotLines(false)
+    , m_dropped(0)
+    , m_queueLines(true)
+    , m_sinks(nullptr)
+{
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+    m_stdout.limiter.setOrigin(LogOrigin::Stdout);
+    m_stderr.limiter.setOrigin(LogOrigin::Stderr);
+}
+
+OutputCapture::~OutputCapture() {
+    stop();
+}
+
+static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Writes all of data unless the fd fails (or would block); retries
+// partial writes and EINTR
+static void writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n > 0) {
+            data += n;
+            length -= (size_t)n;
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+}
+
+bool OutputCapture::openStream(Stream& stream, int targetFd) {
+    if (pipe(stream.pipe) == -1) {
+        return false;
+    }
+
+#ifdef F_SETPIPE_SZ
+    // Extra headroom for bursts; best effort, limited by pipe-max-size
+    fcntl(stream.pipe[1], F_SETPIPE_SZ, PIPE_SIZE);
+#endif
+
+    stream.buffer.reset(new char[READ_BUFFER_SIZE]);
+    stream.used = 0;
+    stream.targetFd = targetFd;
+    stream.origFd = dup(targetFd);
+    dup2(stream.pipe[1], targetFd);
+    setNonBlocking(stream.pipe[0]);
+    return true;
+}
+
+void OutputCapture::restoreStream(Stream& stream) {
+    if (stream.origFd != -1) {
+        dup2(stream.origFd, stream.targetFd);
+        close(stream.origFd);
+        stream.origFd = -1;
+    }
+    if (stream.pipe[0] != -1) { close(stream.pipe[0]); stream.pipe[0] = -1; }
+    if (stream.pipe[1] != -1) { close(stream.pipe[1]); stream.pipe[1] = -1; }
+    stream.buffer.reset();
+    stream.used = 0;
+}
+
+bool OutputCapture::start(std::function<void()> onLines) {
+    if (m_active) return true;
+
+    if (pipe(m_wakePipe) == -1) {
+        return false;
+    }
+    if (!openStream(m_stdout, STDOUT_FILENO)) {
+        stop();
+        return false;
+    }
+    if (!openStream(m_stderr, STDERR_FILENO)) {
+        restoreStream(m_stdout);
+        stop();
+        return false;
+    }
+
+    m_onLines = std::move(onLines);
+    m_active = true;
+    m_thread = std::thread(&OutputCapture::readerMain, this);
+    return true;
+}
+
+void OutputCapture::stop() {
+    if (m_thread.joinable()) {
+        // Reader does a final drain and exits
+        char c = 0;
+        writeAll(m_wakePipe[1], &c, 1);
+        m_thread.join();
+    }
+
+    restoreStream(m_stdout);
+    restoreStream(m_stderr);
+
+    if (m_wakePipe[0] != -1) { close(m_wakePipe[0]); m_wakePipe[0] = -1; }
+    if (m_wakePipe[1] != -1) { close(m_wakePipe[1]); m_wakePipe[1] = -1; }
+
+    m_active = false;
+}
+
+void OutputCapture::setRateLimit(int linesPerSec) {
+    m_stdout.limiter.setRate(linesPerSec);
+    m_stderr.limiter.setRate(linesPerSec);
+}
+
+void OutputCapture::readerMain() {
+    pollfd fds[3];
+    fds[0].fd = m_stdout.pipe[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stderr.pipe[0];
+    fds[1].events = POLLIN;
+    fds[2].fd = m_wakePipe[0];
+    fds[2].events = POLLIN;
+
+    for (;;) {
+        // Wake up for held repeat/suppression notices even when output stops
+        bool pending = m_stdout.limiter.hasPending() || m_stderr.limiter.hasPending();
+        if (poll(fds, 3, pending ? NOTICE_POLL_MS : -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[0].revents) drain(m_stdout);
+        if (fds[1].revents) drain(m_stderr);
+
+        int64_t now = logClockUs();
+        flushLimiter(m_stdout, now);
+        flushLimiter(m_stderr, now);
+
+        if (m_gotLines && m_onLines) {
+            m_onLines();
+        }
+        m_gotLines = false;
+
+        if (fds[2].revents) {
+            // Stop requested; pick up anything written just before
+            drain(m_stdout);
+            drain(m_stderr);
+            break;
+        }
+    }
+}
+
+void OutputCapture::drain(Stream& stream) {
+    bool queueLines = m_queueLines.load(std::memory_order_relaxed) || (m_sinks && m_sinks->active());
+    if (!queueLines) {
+        stream.used = 0;
+    }
+
+    for (;;) {
+        if (stream.used == READ_BUFFER_SIZE) {
+            // A single line filled the buffer; emit it as is
+            pushLine(stream, std::string_view(stream.buffer.get(), stream.used));
+            stream.used = 0;
+        }
+
+        char* readAt = stream.buffer.get() + stream.used;
+        ssize_t bytesRead = read(stream.pipe[0], readAt, READ_BUFFER_SIZE - stream.used);
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        // Pass through to the original fd
+        if (stream.origFd != -1) {
+            writeAll(stream.origFd, readAt, (size_t)bytesRead);
+        }
+
+        if (!queueLines) {
+            continue;
+        }
+
+        size_t filled = stream.used + bytesRead;
+        size_t consumed = splitLines(stream.buffer.get(), filled, stream.used,
+                                     [&](std::string_view line) { pushLine(stream, line); });
+
+        // Keep the unfinished tail at the front for the next read
+        stream.used = filled - consumed;
+        if (consumed > 0 && stream.used > 0) {
+            memmove(stream.buffer.get(), stream.buffer.get() + consumed, stream.used);
+        }
+    }
+}
+
+void OutputCapture::pushLine(Stream& stream, std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (line.empty()) {
+        return;
+    }
+
+    // Stamped as read; the same time drives the rate limit
+    int64_t now = logClockUs();
+    LogOrigin origin = stream.limiter.origin();
+    stream.limiter.submit(line, now, [this, now, origin](std::string_view text) { queueLine(text, now, origin); });
+}
+
+void OutputCapture::flushLimiter(Stream& stream, int64_t now) {
+    LogOrigin origin = stream.limiter.origin();
+    stream.limiter.flush(now, [this, now, origin](std::string_view text) { queueLine(text, now, origin); });
+}
+
+void OutputCapture::queueLine(std::string_view line, int64_t time, LogOrigin origin) {
+    if (m_sinks && m_sinks->active()) {
+        m_sinks->submit(LogSinkWriter::CAPTURE, line, time, origin);
+    }
+    if (!m_queueLines.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // The only copy of the bytes: straight into the queue's ring
+    if (m_lines.push(line, time, origin)) {
+        m_gotLines = true;
+    } else {
+        // Consumer is behind; never block the writer
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
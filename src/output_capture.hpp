@@ -0,0 +1,93 @@
+#ifndef OUTPUT_CAPTURE_HPP
+#define OUTPUT_CAPTURE_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "log_limiter.hpp"
+#include "line_queue.hpp"
+#include "log_sink.hpp"
+
+// Redirects the process's stdout/stderr into pipes and drains them on a
+// dedicated reader thread, so engine writes never block on the game frame.
+// Output is passed through to the original fds and complete lines are
+// stamped and pushed into a lock-free queue for a single consumer (the GUI
+// thread), after each stream's LogLimiter has collapsed repeats and applied
+// its rate.
+class OutputCapture {
+public:
+    OutputCapture();
+    ~OutputCapture();
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+
+    // onLines runs on the reader thread after each batch of new lines
+    bool start(std::function<void()> onLines);
+    void stop();
+    bool active() const { return m_active; }
+
+    // With no consumer (headless), output is only passed through
+    void setLineQueueEnabled(bool enabled) { m_queueLines.store(enabled, std::memory_order_relaxed); }
+
+    // Lines also go to the sinks while they are active; set before start()
+    void setSinks(LogSinkWriter* sinks) { m_sinks = sinks; }
+
+    // Consumer side
+    // The line stays in the queue, and the view valid, until popLine()
+    bool peekLine(LogLine& line) { return m_lines.front(line); }
+    void popLine() { m_lines.pop(); }
+    bool empty() const { return m_lines.empty(); }
+    size_t pending() const { return m_lines.size(); }
+    unsigned takeDropped() { return m_dropped.exchange(0); }
+
+    // Lines per second per stream (0 = unlimited); any thread
+    void setRateLimit(int linesPerSec);
+    const LogLimiter& stdoutLimiter() const { return m_stdout.limiter; }
+    const LogLimiter& stderrLimiter() const { return m_stderr.limiter; }
+
+private:
+    struct Stream {
+        int pipe[2] = { -1, -1 };
+        int origFd = -1;
+        int targetFd = -1;  // STDOUT_FILENO / STDERR_FILENO
+
+        // Reads land after any partial line left from the previous read,
+        // so lines are split in place and only the unfinished tail moves
+        std::unique_ptr<char[]> buffer;
+        size_t used = 0;
+
+        LogLimiter limiter;  // Reader thread
+    };
+
+    bool openStream(Stream& stream, int targetFd);
+    void restoreStream(Stream& stream);
+    void readerMain();
+    void drain(Stream& stream);
+    void pushLine(Stream& stream, std::string_view line);
+    void queueLine(std::string_view line, int64_t time, LogOrigin origin);
+    void flushLimiter(Stream& stream, int64_t now);
+
+    Stream m_stdout;
+    Stream m_stderr;
+    int m_wakePipe[2];
+    bool m_active;
+
+    std::thread m_thread;
+    std::function<void()> m_onLines;
+    bool m_gotLines;  // Reader thread only
+
+    LineQueue<1 << 20, 64 * 1024> m_lines;  // Longest line: READ_BUFFER_SIZE
+    std::atomic<unsigned> m_dropped;
+    std::atomic<bool> m_queueLines;
+    LogSinkWriter* m_sinks;
+
+    static constexpr int PIPE_SIZE = 1 << 20;
+    static constexpr int NOTICE_POLL_MS = 250;
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;  // Also the longest line kept whole
+};
+
+#endif // OUTPUT_CAPTURE_HPP
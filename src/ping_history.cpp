@@ -0,0 +1,83 @@
+#include "ping_history.hpp"
+#include <algorithm>
+#include <cstring>
+
+void PingHistory::grow(int slot) {
+    if (slot < slots()) return;
+
+    size_t n = (size_t)slot + 1;
+    m_ping.resize(n * SAMPLES);
+    m_loss.resize(n * SAMPLES);
+    m_sorted.resize(n * SAMPLES);
+    m_next.resize(n);
+    m_count.resize(n);
+    m_sum.resize(n);
+    m_total.resize(n);
+}
+
+void PingHistory::reset(int slot) {
+    if (slot < 0 || slot >= slots()) return;
+
+    m_next[slot] = 0;
+    m_count[slot] = 0;
+    m_sum[slot] = 0;
+    m_total[slot] = 0;
+}
+
+void PingHistory::push(int slot, int ping, int loss) {
+    if (slot < 0) return;
+    grow(slot);
+
+    uint16_t value = (uint16_t)std::clamp(ping, 0, 65535);
+    size_t base = (size_t)slot * SAMPLES;
+    uint16_t* sorted = &m_sorted[base];
+    int count = m_count[slot];
+    int next = m_next[slot];
+
+    // Take the evicted reading out of the sorted window
+    if (count == SAMPLES) {
+        uint16_t old = m_ping[base + next];
+        uint16_t* at = std::lower_bound(sorted, sorted + count, old);
+        memmove(at, at + 1, (size_t)(sorted + count - at - 1) * sizeof(uint16_t));
+        m_sum[slot] -= old;
+        count--;
+    }
+    uint16_t* at = std::upper_bound(sorted, sorted + count, value);
+    memmove(at + 1, at, (size_t)(sorted + count - at) * sizeof(uint16_t));
+    *at = value;
+
+    m_ping[base + next] = value;
+    m_loss[base + next] = (uint8_t)std::clamp(loss, 0, 100);
+    m_sum[slot] += value;
+    m_count[slot] = (uint8_t)(count + 1);
+    m_next[slot] = (uint8_t)((next + 1) % SAMPLES);
+    m_total[slot]++;
+}
+
+int PingHistory::minPing(int slot) const {
+    return count(slot) > 0 ? m_sorted[(size_t)slot * SAMPLES] : 0;
+}
+
+int PingHistory::avgPing(int slot) const {
+    int n = count(slot);
+    return n > 0 ? (int)((m_sum[slot] + n / 2) / n) : 0;
+}
+
+// Nearest rank: the smallest reading at or above 95% of the window
+int PingHistory::p95Ping(int slot) const {
+    int n = count(slot);
+    if (n == 0) return 0;
+    int rank = (95 * n + 99) / 100;
+    return m_sorted[(size_t)slot * SAMPLES + rank - 1];
+}
+
+void PingHistory::copy(int slot, uint16_t* pings, uint8_t* losses) const {
+    int n = count(slot);
+    size_t base = (size_t)slot * SAMPLES;
+    int first = (m_next[slot] - n + SAMPLES) % SAMPLES;
+    for (int i = 0; i < n; i++) {
+        int at = (first + i) % SAMPLES;
+        pings[i] = m_ping[base + at];
+        losses[i] = m_loss[base + at];
+    }
+}
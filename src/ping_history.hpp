@@ -0,0 +1,46 @@
+#ifndef PING_HISTORY_HPP
+#define PING_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The last SAMPLES ping and loss readings of every client slot, as a ring
+// per slot. Storage is struct-of-arrays: one array of pings for all slots,
+// one of losses, one of ring positions and so on, so a sampling tick over
+// the whole server walks a few contiguous blocks. Min, average and 95th
+// percentile are kept current on each push: the average from a running
+// sum, the order statistics from a sorted copy of the window that the push
+// edits in place. Game thread only.
+class PingHistory {
+public:
+    static constexpr int SAMPLES = 60;
+
+    PingHistory() = default;
+
+    void reset(int slot);  // A new client in the slot
+    void push(int slot, int ping, int loss);
+
+    int count(int slot) const { return slot < slots() ? m_count[slot] : 0; }
+    uint32_t total(int slot) const { return slot < slots() ? m_total[slot] : 0; }  // Pushes since reset
+    int minPing(int slot) const;
+    int avgPing(int slot) const;
+    int p95Ping(int slot) const;
+
+    // Writes count(slot) samples, oldest first
+    void copy(int slot, uint16_t* pings, uint8_t* losses) const;
+
+private:
+    int slots() const { return (int)m_count.size(); }
+    void grow(int slot);
+
+    std::vector<uint16_t> m_ping;    // [slot * SAMPLES + i], ring order
+    std::vector<uint8_t> m_loss;     // Percent, same layout
+    std::vector<uint16_t> m_sorted;  // The slot's window, ascending
+    std::vector<uint8_t> m_next;     // Ring position of the next push
+    std::vector<uint8_t> m_count;
+    std::vector<uint32_t> m_sum;     // Of the pings in the window
+    std::vector<uint32_t> m_total;
+};
+
+#endif // PING_HISTORY_HPP
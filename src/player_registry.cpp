@@ -0,0 +1,149 @@
+#include "player_registry.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Copies text into a fixed buffer, cut before a partial UTF-8 character if
+// it does not fit. Returns true if the buffer changed.
+template <size_t N>
+bool copyText(char (&dst)[N], std::string_view text) {
+    size_t length = std::min(text.size(), N - 1);
+    if (length < text.size()) {
+        while (length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80) {
+            length--;
+        }
+    }
+    if (strlen(dst) == length && memcmp(dst, text.data(), length) == 0) {
+        return false;
+    }
+    memcpy(dst, text.data(), length);
+    dst[length] = '\0';
+    return true;
+}
+
+} // namespace
+
+bool PlayerRegistry::isPendingAuthId(std::string_view authid) {
+    return authid.empty() || authid.find("PENDING") != std::string_view::npos;
+}
+
+PlayerInfo& PlayerRegistry::slot(int index) {
+    if ((size_t)index >= m_slots.size()) {
+        m_slots.resize((size_t)index + 1);
+        m_leftUserid.resize((size_t)index + 1);
+    }
+    return m_slots[index];
+}
+
+void PlayerRegistry::connect(int index, int userid, std::string_view name, std::string_view authid) {
+    if (index <= 0) return;
+
+    PlayerInfo& row = slot(index);
+    leave(index);  // In again once put in the server
+
+    bool dirty = false;
+    if (row.userid != userid) {
+        row = PlayerInfo();
+        row.index = index;
+        row.userid = userid;
+        m_pings.reset(index);
+        dirty = true;
+    }
+    dirty |= copyText(row.name, name);
+    dirty |= storeAuthId(row, authid);
+    if (dirty) {
+        changed(row);
+    }
+}
+
+void PlayerRegistry::putInServer(int index, int userid, std::string_view name, std::string_view authid) {
+    if (index <= 0) return;
+
+    // The plugin may have been loaded after this client connected
+    if (slot(index).userid != userid) {
+        connect(index, userid, name, authid);
+    } else {
+        setAuthId(index, authid);
+    }
+    join(index);
+}
+
+void PlayerRegistry::disconnect(int index) {
+    if (index <= 0 || (size_t)index >= m_slots.size()) return;
+
+    leave(index);
+    m_leftUserid[index] = m_slots[index].userid;
+    m_slots[index] = PlayerInfo();
+    m_pings.reset(index);
+}
+
+void PlayerRegistry::rename(int index, std::string_view name) {
+    if (index <= 0 || (size_t)index >= m_slots.size()) return;
+
+    PlayerInfo& row = m_slots[index];
+    if (row.userid != 0 && !name.empty() && copyText(row.name, name)) {
+        changed(row);
+    }
+}
+
+void PlayerRegistry::setAuthId(int index, std::string_view authid) {
+    PlayerInfo& row = m_slots[index];
+    if (storeAuthId(row, authid)) {
+        changed(row);
+    }
+}
+
+// A validated ID is never replaced by a pending one from a reconnect
+bool PlayerRegistry::storeAuthId(PlayerInfo& row, std::string_view authid) {
+    if (isPendingAuthId(authid) && !isPendingAuthId(row.steamId)) return false;
+    return copyText(row.steamId, authid);
+}
+
+void PlayerRegistry::sample(int index, int ping, int loss, int health, int frags, int deaths) {
+    PlayerInfo& row = m_slots[index];
+    row.ping = ping;
+    row.loss = loss;
+    row.health = health;
+    row.frags = frags;
+    row.deaths = deaths;
+
+    // Every sample moves the history, so the row always changes
+    m_pings.push(index, ping, loss);
+    row.pingMin = m_pings.minPing(index);
+    row.pingAvg = m_pings.avgPing(index);
+    row.pingP95 = m_pings.p95Ping(index);
+    row.historyLength = m_pings.count(index);
+    m_pings.copy(index, row.pingHistory, row.lossHistory);
+    changed(row);
+}
+
+void PlayerRegistry::rows(std::vector<PlayerInfo>& out) const {
+    out.reserve(out.size() + m_inGame.size());
+    for (int index : m_inGame) {
+        out.push_back(m_slots[index]);
+    }
+}
+
+bool PlayerRegistry::isInGame(int index) const {
+    return std::binary_search(m_inGame.begin(), m_inGame.end(), index);
+}
+
+bool PlayerRegistry::tracks(int index, int userid) const {
+    if (index <= 0 || (size_t)index >= m_slots.size()) return false;
+    return (m_slots[index].userid == userid && isInGame(index)) || m_leftUserid[index] == userid;
+}
+
+void PlayerRegistry::join(int index) {
+    auto it = std::lower_bound(m_inGame.begin(), m_inGame.end(), index);
+    if (it == m_inGame.end() || *it != index) {
+        m_inGame.insert(it, index);
+    }
+}
+
+void PlayerRegistry::leave(int index) {
+    auto it = std::lower_bound(m_inGame.begin(), m_inGame.end(), index);
+    if (it != m_inGame.end() && *it == index) {
+        m_inGame.erase(it);
+    }
+}
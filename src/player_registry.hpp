@@ -0,0 +1,89 @@
+#ifndef PLAYER_REGISTRY_HPP
+#define PLAYER_REGISTRY_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ping_history.hpp"
+
+// One row of the player table. The text is held in fixed buffers sized to
+// the engine's limits, so copying rows into a snapshot never allocates.
+struct PlayerInfo {
+    int index = 0;   // Client slot (edict index)
+    int userid = 0;  // Engine userid, unique per connection; 0 = no client
+    uint32_t generation = 0;  // New value whenever any field below changes
+    char name[32] = {};
+    char steamId[64] = {};
+    int ping = 0;
+    int loss = 0;  // Percent
+    int health = 0;
+    int frags = 0;
+    int deaths = 0;  // From the game event log, this map
+
+    // Ping over the history window, and the window itself, oldest first
+    int pingMin = 0;
+    int pingAvg = 0;
+    int pingP95 = 0;
+    int historyLength = 0;
+    uint16_t pingHistory[PingHistory::SAMPLES] = {};
+    uint8_t lossHistory[PingHistory::SAMPLES] = {};
+};
+
+// The clients on the server, kept current by the ClientConnect,
+// ClientPutInServer, ClientDisconnect and ClientUserInfoChanged hooks,
+// plus a per-tick check of each slot's userid for the bots those hooks
+// never see. Names and auth IDs are cached for as
+// long as the userid stays the same, a map change included; only ping,
+// loss, health, frags and deaths are sampled, on the sampling tick, and
+// ping and loss also go into each slot's history. Game thread only.
+class PlayerRegistry {
+public:
+    PlayerRegistry() : m_generation(0) {}
+
+    // Client hooks. A slot whose userid changed is a new connection.
+    void connect(int index, int userid, std::string_view name, std::string_view authid);
+    void putInServer(int index, int userid, std::string_view name, std::string_view authid);
+    void disconnect(int index);
+    void rename(int index, std::string_view name);
+
+    // New map: clients come back through putInServer
+    void leaveAll() { m_inGame.clear(); }
+
+    // Slots with a client in the game, ascending
+    const std::vector<int>& inGame() const { return m_inGame; }
+    bool isInGame(int index) const;
+
+    // True if the hooks already account for this connection: it is in the
+    // game, or it has left and the engine still reports its userid
+    bool tracks(int index, int userid) const;
+
+    // Auth IDs read "STEAM_ID_PENDING" until the client is validated
+    bool authPending(int index) const { return isPendingAuthId(m_slots[index].steamId); }
+    void setAuthId(int index, std::string_view authid);
+
+    // The volatile fields, sampled for in-game slots only, once per tick
+    void sample(int index, int ping, int loss, int health, int frags, int deaths);
+
+    const PlayerInfo& row(int index) const { return m_slots[index]; }
+
+    // Appends the rows of every in-game slot
+    void rows(std::vector<PlayerInfo>& out) const;
+
+    static bool isPendingAuthId(std::string_view authid);
+
+private:
+    PlayerInfo& slot(int index);
+    void join(int index);
+    void leave(int index);
+    static bool storeAuthId(PlayerInfo& row, std::string_view authid);
+    void changed(PlayerInfo& row) { row.generation = ++m_generation; }
+
+    std::vector<PlayerInfo> m_slots;  // By edict index; [0] unused
+    std::vector<int> m_inGame;
+    std::vector<int> m_leftUserid;  // By edict index, the last disconnect
+    PingHistory m_pings;
+    uint32_t m_generation;
+};
+
+#endif // PLAYER_REGISTRY_HPP
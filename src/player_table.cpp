@@ -1,9 +1,14 @@
 #include "player_table.hpp"
 #include <FL/Fl.H>
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <strings.h>
 
 PlayerTable::PlayerTable(int x, int y, int w, int h, const char* label)
     : Fl_Table(x, y, w, h, label)
+    , m_sortCol(COL_INDEX)
+    , m_sortDescending(false)
     , m_hoverRow(-1)
     , m_hoverCol(-1)
 {
@@ -23,22 +28,176 @@ void PlayerTable::updateColumnWidths() {
     int availableW = w() - scrollbarW - 4;  // Account for scrollbar and borders
 
     // Column widths as percentages (total = 100%)
-    // Index: 5%, Name: 40%, Ping: 8%, HP: 8%, Frags: 9%, Kick: 15%, Ban: 15%
-    col_width(COL_INDEX, availableW * 5 / 100);
-    col_width(COL_NAME, availableW * 40 / 100);
-    col_width(COL_PING, availableW * 8 / 100);
-    col_width(COL_HEALTH, availableW * 8 / 100);
-    col_width(COL_FRAGS, availableW * 9 / 100);
-    col_width(COL_KICK, availableW * 15 / 100);
-    col_width(COL_BAN, availableW * 15 / 100);
+    // Index: 4%, Name: 20%, Ping: 6%, History: 14%, Min/Avg/P95: 6% each,
+    // HP: 6%, Frags: 6%, Deaths: 7%, Kick: 9%, Ban: 10%
+    col_width(COL_INDEX, availableW * 4 / 100);
+    col_width(COL_NAME, availableW * 20 / 100);
+    col_width(COL_PING, availableW * 6 / 100);
+    col_width(COL_HISTORY, availableW * 14 / 100);
+    col_width(COL_MIN, availableW * 6 / 100);
+    col_width(COL_AVG, availableW * 6 / 100);
+    col_width(COL_P95, availableW * 6 / 100);
+    col_width(COL_HEALTH, availableW * 6 / 100);
+    col_width(COL_FRAGS, availableW * 6 / 100);
+    col_width(COL_DEATHS, availableW * 7 / 100);
+    col_width(COL_KICK, availableW * 9 / 100);
+    col_width(COL_BAN, availableW * 10 / 100);
 }
 
 void PlayerTable::setPlayers(const std::vector<PlayerInfo>& players) {
-    m_players = players;
-    rows(static_cast<int>(players.size()));
+    size_t count = players.size();
+
+    // A join or a leave changes the row count; that repaints everything
+    if (count != m_players.size()) {
+        m_players = players;
+        m_text.resize(count);  // Stale entries fail the generation check
+        m_order.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            m_order[i] = static_cast<int>(i);
+        }
+        std::sort(m_order.begin(), m_order.end(), [this](int a, int b) { return before(a, b); });
+        m_dirty.assign(count, 0);
+        rows(static_cast<int>(count));
+        redraw();
+        return;
+    }
+
+    m_changed.assign(count, 0);
+    bool anyChanged = false;
+    for (size_t i = 0; i < count; i++) {
+        const PlayerInfo& from = m_players[i];
+        const PlayerInfo& to = players[i];
+        if (from.userid == to.userid && from.generation == to.generation) continue;
+
+        m_changed[i] = changedCells(from, to);
+        m_players[i] = to;
+        anyChanged |= m_changed[i] != 0;
+    }
+    if (!anyChanged) return;
+
+    // A row now showing a different player repaints all of its data cells
+    m_previousOrder = m_order;
+    sortRows();
+    for (size_t row = 0; row < count; row++) {
+        int player = m_order[row];
+        markDirty(static_cast<int>(row), player == m_previousOrder[row] ? m_changed[player] : DATA_CELLS);
+    }
+}
+
+// The number a column shows and sorts by; History sorts like Avg
+int PlayerTable::cellValue(const PlayerInfo& player, int col) {
+    switch (col) {
+        case COL_INDEX: return player.index;
+        case COL_PING: return player.ping;
+        case COL_HISTORY: return player.pingAvg;
+        case COL_MIN: return player.pingMin;
+        case COL_AVG: return player.pingAvg;
+        case COL_P95: return player.pingP95;
+        case COL_HEALTH: return player.health;
+        case COL_FRAGS: return player.frags;
+        case COL_DEATHS: return player.deaths;
+        default: return 0;
+    }
+}
+
+const char* PlayerTable::cellText(int player, int col) {
+    RowText& text = m_text[player];
+    const PlayerInfo& info = m_players[player];
+    if (text.generation != info.generation) {
+        text.generation = info.generation;
+        for (int c = 0; c < NUM_COLS; c++) {
+            if (c == COL_NAME || c == COL_HISTORY || isButtonCol(c)) continue;
+            snprintf(text.cells[c], sizeof(text.cells[c]), "%d", cellValue(info, c));
+        }
+    }
+    return text.cells[col];
+}
+
+// Ties fall back to slot order, so the order is total and stable
+bool PlayerTable::before(int a, int b) const {
+    const PlayerInfo& pa = m_players[a];
+    const PlayerInfo& pb = m_players[b];
+    int cmp;
+    if (m_sortCol == COL_NAME) {
+        cmp = strcasecmp(pa.name, pb.name);
+    } else {
+        int va = cellValue(pa, m_sortCol);
+        int vb = cellValue(pb, m_sortCol);
+        cmp = (va > vb) - (va < vb);
+    }
+    if (cmp != 0) {
+        return m_sortDescending ? cmp > 0 : cmp < 0;
+    }
+    return pa.index < pb.index;
+}
+
+// Live updates move few rows, so the previous order is nearly sorted and
+// an insertion sort over it is close to one pass
+void PlayerTable::sortRows() {
+    for (size_t i = 1; i < m_order.size(); i++) {
+        int player = m_order[i];
+        size_t j = i;
+        while (j > 0 && before(player, m_order[j - 1])) {
+            m_order[j] = m_order[j - 1];
+            j--;
+        }
+        m_order[j] = player;
+    }
+}
+
+// Clicking the sorted column flips the direction. Names and slots start
+// ascending, numbers descending (highest ping or score first).
+void PlayerTable::setSort(int col) {
+    if (col == m_sortCol) {
+        m_sortDescending = !m_sortDescending;
+    } else {
+        m_sortCol = col;
+        m_sortDescending = col != COL_INDEX && col != COL_NAME;
+    }
+    std::sort(m_order.begin(), m_order.end(), [this](int a, int b) { return before(a, b); });
     redraw();
 }
 
+// Data cells that show something different; a different player in the
+// row changes all of them
+uint32_t PlayerTable::changedCells(const PlayerInfo& from, const PlayerInfo& to) {
+    auto bit = [](int col) { return 1u << col; };
+    if (from.userid != to.userid || from.index != to.index) {
+        return DATA_CELLS;
+    }
+
+    uint32_t cells = 0;
+    if (strcmp(from.name, to.name) != 0) cells |= bit(COL_NAME);
+    if (from.ping != to.ping) cells |= bit(COL_PING);
+    if (from.historyLength != to.historyLength ||
+        memcmp(from.pingHistory, to.pingHistory, sizeof(from.pingHistory)) != 0 ||
+        memcmp(from.lossHistory, to.lossHistory, sizeof(from.lossHistory)) != 0) {
+        cells |= bit(COL_HISTORY);
+    }
+    if (from.pingMin != to.pingMin) cells |= bit(COL_MIN);
+    if (from.pingAvg != to.pingAvg) cells |= bit(COL_AVG);
+    if (from.pingP95 != to.pingP95) cells |= bit(COL_P95);
+    if (from.health != to.health) cells |= bit(COL_HEALTH);
+    if (from.frags != to.frags) cells |= bit(COL_FRAGS);
+    if (from.deaths != to.deaths) cells |= bit(COL_DEATHS);
+    return cells;
+}
+
+// Fl_Table repaints the bounding box of the marked cells; draw_cell skips
+// the ones in the box that are not dirty. Rows out of view only keep the
+// mark, and scrolling them in repaints them anyway.
+void PlayerTable::markDirty(int row, uint32_t cells) {
+    if (row < 0 || row >= static_cast<int>(m_dirty.size()) || cells == 0) return;
+
+    m_dirty[row] |= cells;
+    if (row < toprow || row > botrow) return;
+    for (int col = 0; col < NUM_COLS; col++) {
+        if (cells & (1u << col)) {
+            redraw_range(row, row, col, col);
+        }
+    }
+}
+
 void PlayerTable::setKickCallback(std::function<void(int)> callback) {
     m_kickCallback = callback;
 }
@@ -56,8 +215,19 @@ void PlayerTable::draw_cell(TableContext context, int row, int col,
             fl_color(FL_BLACK);
             fl_font(FL_HELVETICA_BOLD, 12);
 
-            const char* headers[] = {"#", "Name", "Ping", "HP", "Frags", "Kick", "Ban"};
+            const char* headers[] = {"#", "Name", "Ping", "History", "Min", "Avg", "P95", "HP", "Frags", "Deaths", "Kick", "Ban"};
             fl_draw(headers[col], x + 4, y, w - 8, h, FL_ALIGN_LEFT);
+
+            // Sort direction arrow
+            if (col == m_sortCol) {
+                int ax = x + w - 11;
+                int ay = y + h / 2;
+                if (m_sortDescending) {
+                    fl_polygon(ax, ay - 2, ax + 7, ay - 2, ax + 3, ay + 2);
+                } else {
+                    fl_polygon(ax, ay + 2, ax + 7, ay + 2, ax + 3, ay - 2);
+                }
+            }
             fl_pop_clip();
             break;
         }
@@ -65,14 +235,19 @@ void PlayerTable::draw_cell(TableContext context, int row, int col,
         case CONTEXT_CELL: {
             if (row < 0 || row >= static_cast<int>(m_players.size())) break;
 
+            // Partial redraw: leave clean cells as they are
+            uint32_t cell = 1u << col;
+            if (!(damage() & FL_DAMAGE_ALL) && !(m_dirty[row] & cell)) break;
+            m_dirty[row] &= ~cell;
+
             fl_push_clip(x, y, w, h);
 
             // Alternating row colors
             Fl_Color bgColor = (row % 2 == 0) ? FL_WHITE : fl_rgb_color(248, 248, 248);
             fl_draw_box(FL_FLAT_BOX, x, y, w, h, bgColor);
 
-            const PlayerInfo& player = m_players[row];
-            char buf[64];
+            int playerRow = m_order[row];
+            const PlayerInfo& player = m_players[playerRow];
 
             if (isButtonCol(col)) {
                 bool hover = (row == m_hoverRow && col == m_hoverCol);
@@ -83,24 +258,15 @@ void PlayerTable::draw_cell(TableContext context, int row, int col,
                 fl_font(FL_HELVETICA, 12);
 
                 switch (col) {
-                    case COL_INDEX:
-                        snprintf(buf, sizeof(buf), "%d", player.index);
-                        fl_draw(buf, x + 4, y, w - 8, h, FL_ALIGN_LEFT);
-                        break;
                     case COL_NAME:
-                        fl_draw(player.name.c_str(), x + 4, y, w - 8, h, FL_ALIGN_LEFT);
+                        fl_draw(player.name, x + 4, y, w - 8, h, FL_ALIGN_LEFT);
                         break;
-                    case COL_PING:
-                        snprintf(buf, sizeof(buf), "%d", player.ping);
-                        fl_draw(buf, x + 4, y, w - 8, h, FL_ALIGN_RIGHT);
+                    case COL_HISTORY:
+                        drawSparkline(x + 3, y + 3, w - 6, h - 6, player);
                         break;
-                    case COL_HEALTH:
-                        snprintf(buf, sizeof(buf), "%d", player.health);
-                        fl_draw(buf, x + 4, y, w - 8, h, FL_ALIGN_RIGHT);
-                        break;
-                    case COL_FRAGS:
-                        snprintf(buf, sizeof(buf), "%d", player.frags);
-                        fl_draw(buf, x + 4, y, w - 8, h, FL_ALIGN_RIGHT);
+                    default:
+                        fl_draw(cellText(playerRow, col), x + 4, y, w - 8, h,
+                                col == COL_INDEX ? FL_ALIGN_LEFT : FL_ALIGN_RIGHT);
                         break;
                 }
             }
@@ -114,6 +280,57 @@ void PlayerTable::draw_cell(TableContext context, int row, int col,
     }
 }
 
+// Only a Kick or Ban cell shows hover; moving between other cells repaints
+// nothing
+void PlayerTable::setHover(int row, int col) {
+    if (row < 0 || row >= static_cast<int>(m_players.size()) || !isButtonCol(col)) {
+        row = col = -1;
+    }
+    if (row == m_hoverRow && col == m_hoverCol) return;
+
+    markDirty(m_hoverRow, m_hoverCol >= 0 ? 1u << m_hoverCol : 0);
+    markDirty(row, col >= 0 ? 1u << col : 0);
+    m_hoverRow = row;
+    m_hoverCol = col;
+    fl_cursor(row >= 0 ? FL_CURSOR_HAND : FL_CURSOR_DEFAULT);
+}
+
+// Ping over the history window, newest at the right, scaled to the
+// window's worst reading (at least 100 ms so a steady line sits low).
+// Samples with loss get a red tick along the bottom.
+void PlayerTable::drawSparkline(int x, int y, int w, int h, const PlayerInfo& player) {
+    int n = player.historyLength;
+    if (n < 1 || w < 4 || h < 4) return;
+
+    int top = 100;
+    for (int i = 0; i < n; i++) {
+        if (player.pingHistory[i] > top) top = player.pingHistory[i];
+    }
+
+    int slots = PingHistory::SAMPLES - 1;
+    auto px = [&](int i) { return x + w - 1 - (n - 1 - i) * (w - 1) / slots; };
+    int lineH = h - 2;  // Room for the loss ticks
+
+    fl_color(fl_rgb_color(200, 60, 60));
+    for (int i = 0; i < n; i++) {
+        if (player.lossHistory[i] > 0) {
+            fl_line(px(i), y + h - 1, px(i), y + h - 2);
+        }
+    }
+
+    fl_color(fl_rgb_color(40, 110, 190));
+    if (n == 1) {
+        int py = y + lineH - 1 - player.pingHistory[0] * (lineH - 1) / top;
+        fl_line(px(0), py, px(0), py);
+        return;
+    }
+    fl_begin_line();
+    for (int i = 0; i < n; i++) {
+        fl_vertex(px(i), y + lineH - 1 - player.pingHistory[i] * (lineH - 1) / top);
+    }
+    fl_end_line();
+}
+
 void PlayerTable::drawButton(int x, int y, int w, int h, const char* label, bool hover) {
     Fl_Color bgColor = hover ? fl_rgb_color(184, 212, 240) : fl_rgb_color(221, 221, 221);
     fl_draw_box(FL_UP_BOX, x, y, w, h, bgColor);
@@ -130,30 +347,15 @@ int PlayerTable::handle(int event) {
     bool mouseInside = Fl::event_inside(this);
 
     switch (event) {
-        case FL_MOVE: {
-            cursor2rowcol(row, col, resizeFlag);
-
-            if (row != m_hoverRow || col != m_hoverCol) {
-                m_hoverRow = row;
-                m_hoverCol = col;
-                // Show hand cursor over kick/ban buttons
-                if (isButtonCol(col) && row >= 0 && row < static_cast<int>(m_players.size())) {
-                    fl_cursor(FL_CURSOR_HAND);
-                } else {
-                    fl_cursor(FL_CURSOR_DEFAULT);
-                }
-                redraw();
+        case FL_MOVE:
+            if (cursor2rowcol(row, col, resizeFlag) != CONTEXT_CELL) {
+                row = col = -1;
             }
+            setHover(row, col);
             return 1;
-        }
 
         case FL_LEAVE:
-            if (m_hoverRow >= 0 || m_hoverCol >= 0) {
-                m_hoverRow = -1;
-                m_hoverCol = -1;
-                fl_cursor(FL_CURSOR_DEFAULT);
-                redraw();
-            }
+            setHover(-1, -1);
             return 1;
 
         case FL_MOUSEWHEEL:
@@ -165,10 +367,15 @@ int PlayerTable::handle(int event) {
 
         case FL_PUSH: {
             Fl::focus(nullptr);  // Clear focus from any input
-            cursor2rowcol(row, col, resizeFlag);
+            TableContext context = cursor2rowcol(row, col, resizeFlag);
+
+            if (context == CONTEXT_COL_HEADER && col >= 0 && col < NUM_COLS && !isButtonCol(col)) {
+                setSort(col);
+                return 1;
+            }
 
-            if (row >= 0 && row < static_cast<int>(m_players.size())) {
-                int playerIndex = m_players[row].index;
+            if (context == CONTEXT_CELL && row >= 0 && row < static_cast<int>(m_players.size())) {
+                int playerIndex = m_players[m_order[row]].index;
 
                 if (col == COL_KICK && m_kickCallback) {
                     m_kickCallback(playerIndex);
@@ -3,19 +3,19 @@
 
 #include <FL/Fl_Table.H>
 #include <FL/fl_draw.H>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
 
-struct PlayerInfo {
-    int index;
-    std::string name;
-    int ping;
-    int health;
-    int frags;
-    std::string steamId;
-};
+#include "player_registry.hpp"
 
+// Player list, sortable by any column (click a header). Rows are shown
+// through a permutation of the player array, so sorting never moves
+// PlayerInfo; each update re-sorts the previous order with an insertion
+// sort, one pass when little changed. Updates are diffed per player, keyed
+// by userid, and only changed cells in view are repainted. Numbers are
+// formatted once per row generation. Fl_Table only asks for visible cells.
 class PlayerTable : public Fl_Table {
 public:
     PlayerTable(int x, int y, int w, int h, const char* label = nullptr);
@@ -31,23 +31,51 @@ protected:
     int handle(int event) override;
 
 private:
-    std::vector<PlayerInfo> m_players;
+    static constexpr int COL_INDEX = 0;
+    static constexpr int COL_NAME = 1;
+    static constexpr int COL_PING = 2;
+    static constexpr int COL_HISTORY = 3;  // Ping sparkline, loss marked under it
+    static constexpr int COL_MIN = 4;
+    static constexpr int COL_AVG = 5;
+    static constexpr int COL_P95 = 6;
+    static constexpr int COL_HEALTH = 7;
+    static constexpr int COL_FRAGS = 8;
+    static constexpr int COL_DEATHS = 9;
+    static constexpr int COL_KICK = 10;
+    static constexpr int COL_BAN = 11;
+    static constexpr int NUM_COLS = 12;
+    static constexpr uint32_t DATA_CELLS = (1u << COL_KICK) - 1;  // Every column before the buttons
+
+    // A row's numbers as text, valid while the generation matches
+    struct RowText {
+        uint32_t generation = 0;
+        char cells[NUM_COLS][12];
+    };
+
+    std::vector<PlayerInfo> m_players;  // As they arrive, in slot order
+    std::vector<int> m_order;           // Display row -> m_players index
+    std::vector<RowText> m_text;        // By m_players index
+    std::vector<uint32_t> m_dirty;      // By display row, one bit per column to repaint
+    std::vector<uint32_t> m_changed;    // setPlayers() scratch, by m_players index
+    std::vector<int> m_previousOrder;   // Likewise
+    int m_sortCol;
+    bool m_sortDescending;
     std::function<void(int)> m_kickCallback;
     std::function<void(int)> m_banCallback;
     int m_hoverRow;
     int m_hoverCol;
 
-    static constexpr int COL_INDEX = 0;
-    static constexpr int COL_NAME = 1;
-    static constexpr int COL_PING = 2;
-    static constexpr int COL_HEALTH = 3;
-    static constexpr int COL_FRAGS = 4;
-    static constexpr int COL_KICK = 5;
-    static constexpr int COL_BAN = 6;
-    static constexpr int NUM_COLS = 7;
-
     void drawButton(int x, int y, int w, int h, const char* label, bool hover);
+    void drawSparkline(int x, int y, int w, int h, const PlayerInfo& player);
     bool isButtonCol(int col) const { return col == COL_KICK || col == COL_BAN; }
+    static uint32_t changedCells(const PlayerInfo& from, const PlayerInfo& to);
+    static int cellValue(const PlayerInfo& player, int col);
+    const char* cellText(int player, int col);
+    bool before(int a, int b) const;
+    void sortRows();
+    void setSort(int col);
+    void markDirty(int row, uint32_t cells);
+    void setHover(int row, int col);
 };
 
 #endif // PLAYER_TABLE_HPP
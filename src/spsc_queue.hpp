@@ -0,0 +1,70 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer queue.
+// Exactly one thread may call push() and exactly one thread may call pop().
+// Capacity must be a power of two; one slot is never used so that a full
+// queue can be told apart from an empty one.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and leaves item untouched) if full.
+    bool push(T&& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) & MASK;
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_items[tail] = std::move(item);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T& item) {
+        T copy(item);
+        return push(std::move(copy));
+    }
+
+    // Consumer side. Returns false if empty.
+    bool pop(T& out) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = std::move(m_items[head]);
+        m_head.store((head + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate; exact only when called from the consumer with no
+    // concurrent push, or from the producer with no concurrent pop.
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return (m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire)) & MASK;
+    }
+
+    static constexpr size_t capacity() { return Capacity - 1; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    T m_items[Capacity];
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif // SPSC_QUEUE_HPP